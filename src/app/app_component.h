@@ -25,6 +25,9 @@
 #include <web/basic_auth.h>
 #include <web/error_handler.h>
 #include <web/request_logger.h>
+#ifndef _WIN32
+#include <web/unix_connection_provider.h>
+#endif
 
 namespace lh {
 
@@ -51,11 +54,19 @@ class AppComponent {
     }());
 
     /**
-     *  Create ConnectionProvider component which listens on the port
+     *  Create ConnectionProvider component which listens on the port,
+     * or on the Unix socket only, if TCP port is disabled
      */
     OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::network::ServerConnectionProvider>, serverConnectionProvider)([] {
-        return oatpp::network::tcp::server::ConnectionProvider::createShared(
-            {web_interface.c_str(), static_cast<v_uint16>(web_port), oatpp::network::Address::IP_4});
+#ifndef _WIN32
+        if (web_port <= 0 && !web_socket.empty())
+            return std::static_pointer_cast<oatpp::network::ServerConnectionProvider>(
+                lh::UnixConnectionProvider::createShared(web_socket));
+#endif
+
+        return std::static_pointer_cast<oatpp::network::ServerConnectionProvider>(
+            oatpp::network::tcp::server::ConnectionProvider::createShared(
+                {web_interface.c_str(), static_cast<v_uint16>(web_port), oatpp::network::Address::IP_4}));
     }());
 
     /**
@@ -9,6 +9,9 @@
 #include <utils/async.h>
 
 #include <app/config.h>
+#ifndef _WIN32
+#include <app/ipc_server.h>
+#endif
 
 #include <web/files.h>
 #include <web/misc.h>
@@ -40,6 +43,7 @@ lh::Session& Application::session() {
 void Application::run() {
     lh::web_interface = m_config.web_interface;
     lh::web_port = m_config.web_port;
+    lh::web_socket = m_config.web_socket;
 
     if (!m_config.web_login.empty() || !m_config.web_password.empty()) {
         OATPP_LOGI("Application::run", "Initializing Web Server on http://%s:%d with authentication for %s:%s", 
@@ -91,6 +95,16 @@ void Application::run() {
     /* Create server which takes provided TCP connections and passes them to HTTP connection handler */
     oatpp::network::Server server(connectionProvider, connectionHandler);
 
+    /* Serve Unix socket connections with the same handler, if it is enabled alongside TCP */
+    std::shared_ptr<oatpp::network::ServerConnectionProvider> socketProvider;
+#ifndef _WIN32
+    if (web_port > 0 && !web_socket.empty()) {
+        socketProvider = UnixConnectionProvider::createShared(web_socket);
+        auto socketServer = std::make_shared<oatpp::network::Server>(socketProvider, connectionHandler);
+        call_async([socketServer] { socketServer->run([]() { return !lh::is_closing.load(); }); });
+    }
+#endif
+
     std::function<bool()> condition = [](){
         return !lh::is_closing.load();
     };
@@ -98,12 +112,23 @@ void Application::run() {
     // Run session run in a separate thread.
     call_async([this] { m_session.run(); });
 
+#ifndef _WIN32
+    // Run control socket for local clients of shared memory storage.
+    if (!m_config.ipc_socket.empty()) {
+        auto ipc = std::make_shared<IpcServer>(m_config.ipc_socket);
+        if (ipc->start())
+            call_async([ipc] { ipc->run(); });
+    }
+#endif
+
     server.run(condition);
 
     OATPP_LOGI("Application::run", "Stopping Web Server");
 
     /* First, stop the ServerConnectionProvider so we don't accept any new connections */
     connectionProvider->stop();
+    if (socketProvider)
+        socketProvider->stop();
 
     /* Signal the stop condition */
     lh::set_close(true);
@@ -21,6 +21,7 @@ std::string web_interface;
 std::string web_login;
 std::string web_password;
 int web_port = 0;
+std::string web_socket;
 
 std::atomic<bool> is_closing(false);
 
@@ -57,10 +58,14 @@ Config::Config(int &argc, char *argv[]) {
         ("web_password",                    po::value<std::string>(&web_password)->default_value(web_password),
                                             "Select which password to use for HTTP server authentication")
         ("web_port",                        po::value<int>(&web_port)->default_value(web_port),
-                                            "Select which port to listen for HTTP server")
+                                            "Select which port to listen for HTTP server (0 disables TCP, if web_socket is set)")
+#ifndef _WIN32
+        ("web_socket",                      po::value<std::string>(&web_socket)->default_value(web_socket),
+                                            "Unix socket path to listen for HTTP server, alongside TCP port (empty disables)")
+#endif
 
         ("download_storage",                po::value<std::string>(&download_storage_arg)->default_value(download_storage_arg),
-                                            "Storage type for downloads")
+                                            "Storage type for downloads (Values: file, memory, ring)")
         ("auto_memory_size",                po::value<bool>(&auto_memory_size)->default_value(auto_memory_size),
                                             "Automatically decide memory size")
         ("auto_memory_size_strategy",       po::value<std::string>(&auto_memory_size_strategy_arg)->default_value(auto_memory_size_strategy_arg),
@@ -74,9 +79,50 @@ Config::Config(int &argc, char *argv[]) {
                                             "Folder to use for storing downloaded files (for File storage)")
         ("torrents_path",                   po::value<std::string>(&torrents_path)->default_value(torrents_path),
                                             "Folder to use for storing active torrent files and fastresume files (for File storage)")
+        ("spill_path",                      po::value<std::string>(&spill_path)->default_value(spill_path),
+                                            "Folder to use for spilling pieces evicted from memory (for Memory storage, empty uses download_path)")
+        ("cache_path",                      po::value<std::string>(&cache_path)->default_value(cache_path),
+                                            "Folder to use for persistent piece cache (for Memory storage, empty uses 'cache' in torrents_path)")
+        ("ring_path",                       po::value<std::string>(&ring_path)->default_value(ring_path),
+                                            "Folder to use for ring files (for Ring storage, empty uses download_path)")
+#ifndef _WIN32
+        ("ipc_socket",                      po::value<std::string>(&ipc_socket)->default_value(ipc_socket),
+                                            "Unix socket path for sharing memory storage with local clients (empty disables)")
+#endif
+        ("use_session_journal",             po::value<bool>(&use_session_journal)->default_value(use_session_journal),
+                                            "Keep metadata and resume data of all torrents in a single journal file in torrents_path")
 
         ("readahead_percents",              po::value<int>(&readahead_percents)->default_value(readahead_percents),
                                             "Percentage to use for upcoming downloads. Rest is used for backward seek (Value: 1 to 100)")
+        ("pinned_memory_percents",          po::value<int>(&pinned_memory_percents)->default_value(pinned_memory_percents),
+                                            "Percentage of memory storage that can be pinned for byte ranges (Value: 0 to 100)")
+        ("next_file_readahead_percents",    po::value<int>(&next_file_readahead_percents)->default_value(next_file_readahead_percents),
+                                            "Percentage of readahead used to prefetch next file when playback is near the end (Value: 0 to 100, 0 disables)")
+        ("sidecar_max_size",                po::value<int>(&sidecar_max_size)->default_value(sidecar_max_size),
+                                            "Maximum size of subtitles, prefetched together with a streamed video (in MB, 0 disables)")
+        ("retention_size",                  po::value<int>(&retention_size)->default_value(retention_size),
+                                            "Data behind each reader, kept in memory for fast rewind (in MB, 0 disables)")
+        ("spill_size",                      po::value<int>(&spill_size)->default_value(spill_size),
+                                            "Disk space per torrent to keep pieces evicted from memory, instead of downloading them again (in MB, 0 disables)")
+        ("cache_size",                      po::value<int>(&cache_size)->default_value(cache_size),
+                                            "Disk space for pieces of memory storage torrents, kept across restarts (in MB, 0 disables)")
+        ("metadata_cache_size",             po::value<int>(&metadata_cache_size)->default_value(metadata_cache_size),
+                                            "Number of resolved magnets, which metadata is kept in 'metadata' in torrents_path (0 disables)")
+        ("ring_size",                       po::value<int>(&ring_size)->default_value(ring_size),
+                                            "Size of a preallocated ring file per torrent (for Ring storage, in MB)")
+        ("read_threads",                    po::value<int>(&read_threads)->default_value(read_threads),
+                                            "Threads, prefetching data ahead of readers from disk (for File storage, 0 disables)")
+
+        ("max_streams",                     po::value<int>(&max_streams)->default_value(max_streams),
+                                            "Maximum concurrent streams for all torrents (0 is unlimited)")
+        ("max_torrent_streams",             po::value<int>(&max_torrent_streams)->default_value(max_torrent_streams),
+                                            "Maximum concurrent streams for a torrent (0 is unlimited)")
+        ("max_file_streams",                po::value<int>(&max_file_streams)->default_value(max_file_streams),
+                                            "Maximum concurrent streams for a file, oldest stream is closed for a new one (0 is unlimited)")
+        ("stream_queue_timeout",            po::value<int>(&stream_queue_timeout)->default_value(stream_queue_timeout),
+                                            "Seconds to wait for a free stream slot, before replying with 503 (0 replies immediately)")
+        ("alert_queue_size",                po::value<int>(&alert_queue_size)->default_value(alert_queue_size),
+                                            "Maximum libtorrent alerts queued between polls, overflow is logged as dropped (minimum 1000)")
 
         ("buffer_size",                     po::value<int>(&buffer_size)->default_value(buffer_size),
                                             "Buffer size, to download before file is ready for playback (in MB)")
@@ -147,7 +193,7 @@ Config::Config(int &argc, char *argv[]) {
                                             "Cache size use for File storage (in MB)")
 
         ("session_save",                    po::value<int>(&session_save)->default_value(session_save),
-                                            "Seconds between session backup")
+                                            "Seconds between saving resume data of changed torrents")
         ("encryption_policy",               po::value<std::string>(&encryption_policy_arg)->default_value(encryption_policy_arg),
                                             "Encryption policy")
         ("spoof_user_agent",                po::value<std::string>(&spoof_user_agent_arg)->default_value(spoof_user_agent_arg),
@@ -172,6 +218,11 @@ Config::Config(int &argc, char *argv[]) {
 
         ("use_libtorrent_logging",          po::value<bool>(&use_libtorrent_logging)->default_value(use_libtorrent_logging),
                                             "Enable full libtorrent logging (log all events)")
+
+        ("trackers_source",                 po::value<std::string>(&trackers_source)->default_value(trackers_source),
+                                            "URL template or local file with extra trackers list (empty to use trackerslist)")
+        ("trackers_cache_ttl",              po::value<int>(&trackers_cache_ttl)->default_value(trackers_cache_ttl),
+                                            "Hours before cached extra trackers list is refreshed")
         ;
 
     po::options_description cmdline_options;
@@ -17,6 +17,7 @@ static std::string VERSION = "0.0.1";
 #endif
 
 const int file_readahead_pieces = 20;
+const int sidecar_pin_ttl = 30 * 60;
 const std::int64_t memory_size_min = 40 * 1024 * 1024;
 const std::int64_t memory_size_max = 400 * 1024 * 1024;
 const std::int64_t disk_cache_size = 12 * 1024 * 1024;
@@ -26,13 +27,14 @@ extern std::string web_interface;
 extern std::string web_login;
 extern std::string web_password;
 extern int web_port;
+extern std::string web_socket;
 extern std::atomic<bool> is_closing;
 
 JS_ENUM(proxy_type_t, none, socks4, socks5, socks5_pw, http, http_pw, i2p_proxy);
 
 JS_ENUM(encryption_type_t, disabled, enabled, forced);
 
-JS_ENUM(storage_type_t, automatic, file, memory);
+JS_ENUM(storage_type_t, automatic, file, memory, ring);
 
 JS_ENUM(auto_memory_strategy_type_t, min, standard, max);
 
@@ -53,6 +55,8 @@ inline char const *storage_to_string(lh::storage_type_t s) {
         return "File";
     case lh::storage_type_t::memory:
         return "Memory";
+    case lh::storage_type_t::ring:
+        return "Ring";
     default:
         return "<>";
     }
@@ -83,6 +87,7 @@ struct Config {
     std::string web_login;
     std::string web_password;
     int web_port = 65225;
+    std::string web_socket = "";
 
     storage_type_t download_storage = storage_type_t::memory;
 
@@ -93,8 +98,29 @@ struct Config {
 
     std::string download_path = ".";
     std::string torrents_path = ".";
+    std::string spill_path = "";
+    std::string cache_path = "";
+    std::string ring_path = "";
+    std::string ipc_socket = "";
+    bool use_session_journal = true;
 
     int readahead_percents = 80;
+    int pinned_memory_percents = 10;
+    int next_file_readahead_percents = 10;
+    int sidecar_max_size = 2;
+    int retention_size = 8;
+    int spill_size = 0;
+    int cache_size = 0;
+    int metadata_cache_size = 100;
+    int ring_size = 512;
+    int read_threads = 4;
+
+    int max_streams = 0;
+    int max_torrent_streams = 0;
+    int max_file_streams = 0;
+    int stream_queue_timeout = 5;
+
+    int alert_queue_size = 10000;
 
     int buffer_size = 20;
     int end_buffer_size = 4;
@@ -153,6 +179,8 @@ struct Config {
     bool remove_original_trackers = false;
     extra_trackers_t add_extra_trackers = extra_trackers_t::best;
     modify_trackers_t modify_trackers_strategy = modify_trackers_t::first_time;
+    std::string trackers_source;
+    int trackers_cache_ttl = 24;
 
     lt_profile_t libtorrent_profile = lt_profile_t::default_profile;
 
@@ -164,14 +192,21 @@ struct Config {
         return !web_login.empty() || !web_password.empty();
     }
 
-    JS_OBJECT(JS_MEMBER(web_interface), JS_MEMBER(web_port),
+    JS_OBJECT(JS_MEMBER(web_interface), JS_MEMBER(web_port), JS_MEMBER(web_socket),
 
               JS_MEMBER(download_storage), JS_MEMBER(auto_memory_size), JS_MEMBER(auto_memory_size_strategy),
               JS_MEMBER(memory_size), JS_MEMBER(auto_adjust_memory_size),
 
-              JS_MEMBER(download_path), JS_MEMBER(torrents_path),
+              JS_MEMBER(download_path), JS_MEMBER(torrents_path), JS_MEMBER(spill_path),
+              JS_MEMBER(cache_path), JS_MEMBER(ring_path), JS_MEMBER(ipc_socket),
+              JS_MEMBER(use_session_journal),
 
-              JS_MEMBER(readahead_percents),
+              JS_MEMBER(readahead_percents), JS_MEMBER(pinned_memory_percents), JS_MEMBER(next_file_readahead_percents),
+              JS_MEMBER(sidecar_max_size), JS_MEMBER(retention_size), JS_MEMBER(spill_size), JS_MEMBER(cache_size), JS_MEMBER(metadata_cache_size), JS_MEMBER(ring_size),
+              JS_MEMBER(read_threads),
+
+              JS_MEMBER(max_streams), JS_MEMBER(max_torrent_streams), JS_MEMBER(max_file_streams),
+              JS_MEMBER(stream_queue_timeout), JS_MEMBER(alert_queue_size),
 
               JS_MEMBER(buffer_size), JS_MEMBER(end_buffer_size), JS_MEMBER(buffer_timeout),
 
@@ -201,6 +236,7 @@ struct Config {
               JS_MEMBER(use_libtorrent_logging),
 
               JS_MEMBER(remove_original_trackers), JS_MEMBER(add_extra_trackers), JS_MEMBER(modify_trackers_strategy),
+              JS_MEMBER(trackers_source), JS_MEMBER(trackers_cache_ttl),
 
               JS_MEMBER(libtorrent_profile)
             );
@@ -0,0 +1,210 @@
+#include "ipc_server.h"
+
+#include <cerrno>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <oatpp/core/base/Environment.hpp>
+
+#include <app/application.h>
+#include <bittorrent/file.h>
+
+#include <utils/async.h>
+
+namespace lh {
+
+IpcServer::IpcServer(std::string path) : m_path(std::move(path)) {}
+
+IpcServer::~IpcServer() {
+    if (m_fd < 0)
+        return;
+
+    ::close(m_fd);
+    ::unlink(m_path.c_str());
+}
+
+bool IpcServer::start() {
+    sockaddr_un addr{};
+    if (m_path.size() >= sizeof(addr.sun_path)) {
+        OATPP_LOGE("IpcServer::start", "Socket path is too long: %s", m_path.c_str());
+        return false;
+    }
+
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_fd < 0) {
+        OATPP_LOGE("IpcServer::start", "Could not create socket: %s", strerror(errno));
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+    ::unlink(m_path.c_str());
+
+    // Socket hands out the shared memory, so only the owner may connect.
+    if (::bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || ::chmod(m_path.c_str(), 0600) != 0 ||
+        ::listen(m_fd, 8) != 0) {
+        OATPP_LOGE("IpcServer::start", "Could not listen on %s: %s", m_path.c_str(), strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    OATPP_LOGI("IpcServer::start", "Listening for local clients on %s", m_path.c_str());
+    return true;
+}
+
+void IpcServer::run() {
+    while (m_fd >= 0 && !lh::is_closing) {
+        pollfd pfd{m_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 500) <= 0)
+            continue;
+
+        int client = ::accept(m_fd, nullptr, nullptr);
+        if (client < 0)
+            continue;
+
+        call_async([client] { handle_client(client); });
+    }
+}
+
+void IpcServer::handle_client(int client) {
+    std::string owner = "ipc-" + std::to_string(client);
+    std::set<std::pair<std::string, int>> pinned;
+    std::string pending;
+    char buffer[1024];
+
+    while (!lh::is_closing) {
+        pollfd pfd{client, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 500);
+        if (ready == 0)
+            continue;
+        if (ready < 0)
+            break;
+
+        auto n = ::recv(client, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+            break;
+
+        pending.append(buffer, std::size_t(n));
+
+        std::size_t pos;
+        bool is_closed = false;
+        while (!is_closed && (pos = pending.find('\n')) != std::string::npos) {
+            auto line = pending.substr(0, pos);
+            pending.erase(0, pos + 1);
+            boost::trim(line);
+            if (line.empty())
+                continue;
+
+            std::vector<std::string> args;
+            boost::split(args, line, boost::is_any_of(" "), boost::token_compress_on);
+            if (args[0] == "READ" && args.size() == 5)
+                pinned.emplace(boost::to_lower_copy(args[1]), std::atoi(args[2].c_str()));
+
+            int pass_fd = -1;
+            is_closed = !send_reply(client, handle_command(client, line, pass_fd), pass_fd);
+            if (pass_fd >= 0)
+                ::close(pass_fd);
+        }
+
+        if (is_closed)
+            break;
+    }
+
+    // Ranges of a disconnected client should not stay pinned until they expire.
+    for (const auto &p : pinned) {
+        try {
+            auto hash = p.first;
+            lh::session().get_torrent(hash)->get_file(p.second)->unpin(owner);
+        } catch (std::exception &e) {
+        }
+    }
+
+    ::close(client);
+}
+
+std::string IpcServer::handle_command(int client, const std::string &line, int &pass_fd) {
+    std::vector<std::string> args;
+    boost::split(args, line, boost::is_any_of(" "), boost::token_compress_on);
+
+    try {
+        if (args.size() < 2)
+            return "ERR Missing arguments";
+
+        auto hash = boost::to_lower_copy(args[1]);
+        auto torrent = lh::session().get_torrent(hash);
+        auto owner = "ipc-" + std::to_string(client);
+
+        if (args[0] == "MAP") {
+            int fd = torrent->shared_memory_fd();
+            struct stat st{};
+            if (fd < 0 || fstat(fd, &st) != 0)
+                return "ERR Torrent is not using shared memory storage";
+
+            // Clients get a read-only descriptor, so they cannot overwrite verified pieces, served to peers and readers.
+            //  Memfd cannot be sealed against writes, since storage writes to it itself.
+            pass_fd = ::open(("/proc/self/fd/" + std::to_string(fd)).c_str(), O_RDONLY | O_CLOEXEC);
+            if (pass_fd < 0)
+                return std::string("ERR Could not open shared memory: ") + strerror(errno);
+
+            return "OK " + std::to_string(torrent->piece_length()) + " " + std::to_string(st.st_size);
+        } else if (args[0] == "PIECES") {
+            std::stringstream ss;
+            ss << "OK";
+            for (const auto &p : torrent->shared_pieces()) {
+                ss << " " << p.first << ":" << p.second;
+            }
+            return ss.str();
+        } else if (args[0] == "READ" && args.size() == 5) {
+            auto file = torrent->get_file(std::stoi(args[2]));
+            file->pin(owner, std::stoll(args[3]), std::stoll(args[4]), std::chrono::seconds(60));
+            return "OK";
+        } else if (args[0] == "RELEASE" && args.size() == 3) {
+            torrent->get_file(std::stoi(args[2]))->unpin(owner);
+            return "OK";
+        }
+
+        return "ERR Unknown command";
+    } catch (std::exception &e) {
+        return std::string("ERR ") + e.what();
+    }
+}
+
+bool IpcServer::send_reply(int client, const std::string &reply, int pass_fd) {
+    std::string data = reply + "\n";
+
+    iovec iov{};
+    iov.iov_base = const_cast<char *>(data.data());
+    iov.iov_len = data.size();
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    if (pass_fd >= 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &pass_fd, sizeof(int));
+    }
+
+    return ::sendmsg(client, &msg, MSG_NOSIGNAL) == ssize_t(data.size());
+}
+
+} // namespace lh
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+namespace lh {
+
+// Control protocol for local clients, which read memory storage through a shared memfd.
+//  Commands are text lines, each reply is a line, starting with OK or ERR:
+//    MAP <hash>                            - piece length and arena size, read-only memfd is attached with SCM_RIGHTS,
+//                                            clients map it with PROT_READ and MAP_SHARED
+//    PIECES <hash>                         - '<piece>:<slot>' pairs for verified pieces in the arena
+//    READ <hash> <file> <offset> <length>  - pin and prioritize byte range of a file (for 60 seconds)
+//    RELEASE <hash> <file>                 - unpin ranges of a file, requested by this client
+class IpcServer {
+  private:
+    std::string m_path;
+    int m_fd = -1;
+
+    static void handle_client(int client);
+    static std::string handle_command(int client, const std::string &line, int &pass_fd);
+    static bool send_reply(int client, const std::string &reply, int pass_fd);
+
+  public:
+    explicit IpcServer(std::string path);
+    ~IpcServer();
+
+    IpcServer(const IpcServer &) = delete;
+    IpcServer &operator=(const IpcServer &) = delete;
+
+    bool start();
+    void run();
+};
+
+} // namespace lh
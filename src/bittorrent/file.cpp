@@ -2,8 +2,11 @@
 
 #include <libtorrent/download_priority.hpp>
 
+#include <boost/algorithm/string.hpp>
+
 #include <oatpp/core/Types.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -12,11 +15,16 @@
 #include <bittorrent/reader.h>
 #include <bittorrent/torrent.h>
 
+#include <utils/exceptions.h>
+#include <utils/path.h>
 #include <utils/pieces.h>
 #include <utils/strings.h>
 
 namespace lh {
 
+const std::vector<std::string> videoExtensions = {"mkv", "mp4", "m4v", "avi", "mov", "wmv", "webm", "mpg", "mpeg", "ts", "m2ts", "flv", "3gp"};
+const std::vector<std::string> sidecarExtensions = {"srt", "ass", "ssa", "sub", "idx", "vtt", "smi"};
+
 File::File(Torrent* torrent, lt::file_index_t index, std::string file_path, std::string file_name,
            std::int64_t file_size, std::int64_t file_offset, lt::download_priority_t priority)
     : m_torrent(torrent), m_index(index), m_path(std::move(file_path)), m_name(std::move(file_name)),
@@ -44,14 +52,58 @@ std::int64_t File::size() const { return m_size; }
 
 std::int64_t File::offset() const { return m_offset; }
 
+std::string File::full_path() const { return path_append(m_torrent->save_path(), m_path); }
+
 std::string File::stream_uri() const {
     return Fmt("/torrents/%s/files/%d/stream/%s", m_torrent->hash().c_str(), m_index, uri_escape(std::string(m_name)).c_str());
 }
 
+std::string File::stem() const {
+    auto i = m_name.rfind('.');
+    if (i == std::string::npos)
+        return m_name;
+
+    return m_name.substr(0, i);
+}
+
+std::string File::directory() const {
+    auto i = m_path.find_last_of("/\\");
+    if (i == std::string::npos)
+        return "";
+
+    return m_path.substr(0, i);
+}
+
+bool File::is_video() const {
+    auto ext = boost::to_lower_copy(get_file_ext(m_name));
+    return std::find(videoExtensions.begin(), videoExtensions.end(), ext) != videoExtensions.end();
+}
+
+bool File::is_sidecar() const {
+    auto ext = boost::to_lower_copy(get_file_ext(m_name));
+    return std::find(sidecarExtensions.begin(), sidecarExtensions.end(), ext) != sidecarExtensions.end();
+}
+
 lt::piece_index_t File::piece_start() const { return m_piece_start; }
 
 lt::piece_index_t File::piece_end() const { return m_piece_end; }
 
+bool File::is_complete() const {
+    // Cached bitfield may lag behind, then the file is just served through a reader.
+    auto pieces = m_torrent->verified_pieces();
+    if (pieces->size() <= int(m_piece_end))
+        return false;
+
+    for (int i = int(m_piece_start); i <= int(m_piece_end); i++) {
+        if (!pieces->get_bit(lt::piece_index_t(i)))
+            return false;
+    }
+
+    return true;
+}
+
+bool File::is_selected() const { return m_isSelected; }
+
 lt::download_priority_t File::priority() const { return m_torrent->file_priority(index()); }
 
 void File::set_priority(lt::download_priority_t priority) {
@@ -136,13 +188,102 @@ void File::set_buffer_progress(double progress) {
 
 std::vector<int> File::buffer_pieces() const { return m_buffer_pieces; };
 
-bool File::has_readers() const { return !m_readers.empty(); }
+// Pins are kept per owner and file, so unpinning a file keeps pins of the same owner on a neighbouring file,
+//  that shares a boundary piece.
+std::string File::pin_owner(const std::string &owner) const { return owner + "@" + std::to_string(int(m_index)); }
+
+void File::pin(const std::string &owner, std::int64_t offset, std::int64_t length, std::chrono::seconds ttl,
+               lt::download_priority_t priority) {
+    if (offset < 0 || offset >= m_size || length <= 0)
+        throw lh::FileException(Fmt("Cannot pin range offset=%s, length=%s for file with size %s", std::to_string(offset).c_str(),
+                                    std::to_string(length).c_str(), std::to_string(m_size).c_str()));
+
+    length = std::min(length, m_size - offset);
+    auto range = region_pieces(m_offset + offset, length, m_torrent->piece_length(), m_torrent->pieces_count());
+
+    OATPP_LOGI("File::pin", "Pinning pieces %d-%d of file %s/%s for '%s'", int(range.first), int(range.second),
+               m_torrent->hash().c_str(), m_name.c_str(), owner.c_str())
+
+    if (m_torrent->is_memory_storage() &&
+        !((lh::memory_storage*) m_torrent->storage())->pin_pieces(pin_owner(owner), range.first, range.second, ttl))
+        throw lh::FileException("Not enough memory left for pinning requested range");
+
+    for (int i = range.first; i <= range.second; i++) {
+        if (m_torrent->have_piece(i))
+            continue;
+
+        // Only urgent pins are time critical, others should not compete with readers.
+        if (priority >= lt::top_priority)
+            m_torrent->set_piece_priority(i, 0, priority);
+        else if (m_torrent->piece_priority(i) < priority)
+            m_torrent->piece_priority(i, priority);
+    }
+}
+
+void File::unpin(const std::string &owner) {
+    OATPP_LOGI("File::unpin", "Unpinning file %s/%s for '%s'", m_torrent->hash().c_str(), m_name.c_str(), owner.c_str())
+
+    if (m_torrent->is_memory_storage())
+        ((lh::memory_storage*) m_torrent->storage())->unpin_pieces(pin_owner(owner), m_piece_start, m_piece_end);
+}
+
+bool File::has_readers() const {
+    std::lock_guard<std::mutex> guard(m_readersMutex);
+    return !m_readers.empty();
+}
+
+std::map<std::int64_t, Reader*> File::readers() const {
+    std::lock_guard<std::mutex> guard(m_readersMutex);
+    return m_readers;
+}
+
+std::int64_t File::read_position() const { return m_read_position; }
+
+std::int64_t File::read_reader() const { return m_read_reader; }
+
+void File::set_read_position(std::int64_t reader, std::int64_t position) {
+    m_read_reader = reader;
+    m_read_position = position;
+}
+
+bool File::has_reader(std::int64_t id) const {
+    std::lock_guard<std::mutex> guard(m_readersMutex);
+    return m_readers.find(id) != m_readers.end();
+}
+
+int File::active_readers() const {
+    std::lock_guard<std::mutex> guard(m_readersMutex);
+    return int(std::count_if(m_readers.begin(), m_readers.end(),
+                             [](const std::pair<const std::int64_t, Reader*> &p) { return !p.second->is_closing(); }));
+}
+
+void File::close_idle_readers() {
+    std::lock_guard<std::mutex> guard(m_readersMutex);
+    for (const auto &p : m_readers) {
+        if (!p.second->is_closing() && p.second->is_idle())
+            p.second->close();
+    }
+}
+
+void File::close_oldest_reader() {
+    std::lock_guard<std::mutex> guard(m_readersMutex);
+    Reader* oldest = nullptr;
+    for (const auto &p : m_readers) {
+        if (!p.second->is_closing() && (oldest == nullptr || p.second->accessed() < oldest->accessed()))
+            oldest = p.second;
+    }
+
+    if (oldest != nullptr)
+        oldest->close();
+}
 
 void File::register_reader(std::int64_t id, Reader* reader) { 
+    std::lock_guard<std::mutex> guard(m_readersMutex);
     m_readers[id] = reader; 
 }
 
 void File::unregister_reader(const std::int64_t id) {
+    std::lock_guard<std::mutex> guard(m_readersMutex);
     if (m_readers.find(id) != m_readers.end()) {
         m_readers.erase(id);
     }
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include <libtorrent/download_priority.hpp>
 #include <libtorrent/file_storage.hpp>
@@ -37,9 +40,14 @@ class File {
     double m_buffer_progress = 0;
     std::int64_t m_start_buffer_size = 0;
     std::int64_t m_end_buffer_size = 0;
+    std::atomic<std::int64_t> m_read_position{-1};
+    std::atomic<std::int64_t> m_read_reader{0};
 
     Config m_config;
     std::map<std::int64_t, Reader*> m_readers;
+    mutable std::mutex m_readersMutex;
+
+    std::string pin_owner(const std::string &owner) const;
 
   public:
     File(Torrent* torrent, lt::file_index_t index, std::string file_path, std::string file_name, std::int64_t file_size,
@@ -52,10 +60,18 @@ class File {
     std::int64_t size() const;
     std::int64_t offset() const;
     std::string stream_uri() const;
+    std::string full_path() const;
+    std::string stem() const;
+    std::string directory() const;
+
+    bool is_video() const;
+    bool is_sidecar() const;
 
     lt::piece_index_t piece_start() const;
     lt::piece_index_t piece_end() const;
+    bool is_complete() const;
 
+    bool is_selected() const;
     lt::download_priority_t priority() const;
     void set_priority(lt::download_priority_t priority);
     void add_buffer_piece(int piece);
@@ -69,7 +85,21 @@ class File {
     void set_buffer_progress(double progress);
     std::vector<int> buffer_pieces() const;
 
+    void pin(const std::string &owner, std::int64_t offset, std::int64_t length, std::chrono::seconds ttl,
+             lt::download_priority_t priority = lt::top_priority);
+    void unpin(const std::string &owner);
+
+    std::int64_t read_position() const;
+    std::int64_t read_reader() const;
+    void set_read_position(std::int64_t reader, std::int64_t position);
+
+    bool has_reader(std::int64_t id) const;
+
     bool has_readers() const;
+    std::map<std::int64_t, Reader*> readers() const;
+    int active_readers() const;
+    void close_idle_readers();
+    void close_oldest_reader();
     void register_reader(std::int64_t id, Reader* reader);
     void unregister_reader(std::int64_t id);
 };
@@ -1,5 +1,8 @@
 #include "memory_storage.h"
 
+#include <app/application.h>
+#include <utils/path.h>
+
 namespace lh {
 
 memory_piece::memory_piece(int i, int length) : index(i), length(length) {
@@ -18,23 +21,34 @@ void memory_piece::reset() {
     size = 0;
 }
 
-memory_buffer::memory_buffer(int index, int length) : index(index), length(length) {
+memory_buffer::memory_buffer(int index, int length, bool is_allocated) : index(index), length(length) {
     pi = -1;
     is_used = false;
+    is_pinned = false;
 
-    buffer.resize(length);
+    if (is_allocated)
+        buffer.resize(length);
 };
 
 bool memory_buffer::is_assigned() const { return pi != -1; };
 
 void memory_buffer::reset() {
     is_used = false;
+    is_pinned = false;
     pi = -1;
     accessed = std::chrono::system_clock::now();
     std::fill(buffer.begin(), buffer.end(), '\0');
 };
 
-memory_storage::memory_storage(lt::storage_params const &params) : lt::storage_interface(params.files) {
+memory_pin::memory_pin(std::string owner, int piece_start, int piece_end, std::chrono::seconds ttl)
+    : owner(std::move(owner)), piece_start(piece_start), piece_end(piece_end) {
+    is_expiring = ttl.count() > 0;
+    expires = std::chrono::system_clock::now() + ttl;
+};
+
+bool memory_pin::is_expired() const { return is_expiring && std::chrono::system_clock::now() >= expires; };
+
+memory_storage::memory_storage(lt::storage_params const &params, std::int64_t size) : lt::storage_interface(params.files) {
     piece_count = 0;
     piece_length = 0;
 
@@ -42,6 +56,7 @@ memory_storage::memory_storage(lt::storage_params const &params) : lt::storage_i
     buffer_limit = 0;
     buffer_used = 0;
     buffer_reserved = 0;
+    pinned_limit = 0;
 
     is_logging = false;
     is_initialized = false;
@@ -49,7 +64,7 @@ memory_storage::memory_storage(lt::storage_params const &params) : lt::storage_i
 
     m_files = params.files;
 
-    capacity = lh::memory_size;
+    capacity = size;
     piece_count = m_files.num_pieces();
     piece_length = m_files.piece_length();
 
@@ -66,24 +81,49 @@ memory_storage::memory_storage(lt::storage_params const &params) : lt::storage_i
         buffer_size = piece_count;
     };
     buffer_limit = buffer_size;
-    OATPP_LOGI("memory_storage", "Using %s memory for %d buffer items", humanize_bytes(buffer_size * piece_length).c_str(),
-                buffer_size);
+    pinned_limit = buffer_size * lh::config().pinned_memory_percents / 100;
+    OATPP_LOGI("memory_storage", "Using %s memory for %d buffer items, %d of them can be pinned",
+                humanize_bytes(buffer_size * piece_length).c_str(), buffer_size, pinned_limit);
 
     reader_pieces.resize(piece_count + 10);
     reserved_pieces.resize(piece_count + 10);
+    pinned_pieces.resize(piece_count + 10);
 };
 
-void memory_storage::initialize(lt::storage_error & /*ec*/) {
-    for (int i = 0; i < buffer_size; i++) {
-        buffers.emplace_back(i, piece_length);
+void memory_storage::initialize(lt::storage_error &ec) {
+    auto err = create_buffers(0, buffer_size);
+    if (err) {
+        ec.ec = err;
+        ec.operation = lt::operation_t::file_fallocate;
+        return;
     }
 
     reader_pieces.resize(piece_count + 10);
     reserved_pieces.resize(piece_count + 10);
+    pinned_pieces.resize(piece_count + 10);
 
     is_initialized = true;
 }
 
+lt::error_code memory_storage::create_buffers(int start, int end) {
+    for (int i = start; i < end; i++) {
+        buffers.emplace_back(i, piece_length);
+    }
+    return lt::error_code();
+}
+
+lt::error_code memory_storage::read_buffer(int bi, char *data, int offset, int length) {
+    std::memcpy(data, &buffers[bi].buffer[offset], length);
+    return lt::error_code();
+}
+
+lt::error_code memory_storage::write_buffer(int bi, const char *data, int offset, int length) {
+    std::memcpy(&buffers[bi].buffer[offset], data, length);
+    return lt::error_code();
+}
+
+bool memory_storage::is_spillable() const { return true; }
+
 std::int64_t memory_storage::get_memory_size() const { return capacity; }
 
 void memory_storage::set_memory_size(std::int64_t s) {
@@ -102,6 +142,7 @@ void memory_storage::set_memory_size(std::int64_t s) {
         buffer_size = piece_count;
     };
     buffer_limit = buffer_size;
+    pinned_limit = buffer_size * lh::config().pinned_memory_percents / 100;
     if (prev_buffer_size == buffer_size) {
         OATPP_LOGI("memory_storage::set_memory_size", "Not increasing buffer due to same size (%s)",
                     humanize_bytes(buffer_size).c_str());
@@ -110,17 +151,28 @@ void memory_storage::set_memory_size(std::int64_t s) {
 
     OATPP_LOGI("memory_storage::set_memory_size", "Increasing buffer to %s buffers", humanize_bytes(buffer_size).c_str());
 
-    for (int i = prev_buffer_size; i < buffer_size; i++) {
-        buffers.emplace_back(i, piece_length);
+    auto err = create_buffers(prev_buffer_size, buffer_size);
+    if (err) {
+        // Storage stays at its previous size, when new buffers could not be backed.
+        OATPP_LOGE("memory_storage::set_memory_size", "Could not create buffers: %s", err.message().c_str());
+        buffer_size = prev_buffer_size;
+        buffer_limit = buffer_size;
+        pinned_limit = buffer_size * lh::config().pinned_memory_percents / 100;
+    }
+
+    // Buffer limit was reset, so pinned buffers should be taken out of it again.
+    for (auto &buffer : buffers) {
+        if (buffer.is_pinned)
+            buffer_limit--;
     }
 }
 
 int memory_storage::get_buffers_count() const {
-    return buffer_size - int(reserved_pieces.count());
+    return buffer_size - int(reserved_pieces.count()) - int(pinned_pieces.count());
 };
 
 int memory_storage::readv(lt::span<lt::iovec_t const> bufs, lt::piece_index_t const pi, int offset, lt::open_mode_t  /*mode*/,
-            lt::storage_error & /*ec*/) {
+            lt::storage_error &ec) {
     if (!is_initialized)
         return 0;
 
@@ -140,15 +192,20 @@ int memory_storage::readv(lt::span<lt::iovec_t const> bufs, lt::piece_index_t co
     for (lt::iovec_t const &b : bufs) {
         size += b.size();
 
-        int const to_copy = std::min(buffers[pieces[piece].bi].buffer.size() - file_offset, std::size_t(b.size()));
-        memcpy(b.data(), &buffers[pieces[piece].bi].buffer[file_offset], to_copy);
+        int const to_copy = std::min(buffers[pieces[piece].bi].length - file_offset, int(b.size()));
+        auto err = read_buffer(pieces[piece].bi, b.data(), file_offset, to_copy);
+        if (err) {
+            ec.ec = err;
+            ec.operation = lt::operation_t::file_read;
+            return -1;
+        }
         file_offset += to_copy;
         n += to_copy;
     };
 
     if (is_logging) {
         OATPP_LOGI("memory_storage::readv", "readv out p: %d, pl: %d, bufs: %d/%d, off: %d, bs: %d, res: %d=%d", piece,
-                    pieces[piece].length, bufs.size(), bufs[0].size(), offset, buffers[pieces[piece].bi].buffer.size(), size,
+                    pieces[piece].length, bufs.size(), bufs[0].size(), offset, buffers[pieces[piece].bi].length, size,
                     n);
     };
 
@@ -158,11 +215,16 @@ int memory_storage::readv(lt::span<lt::iovec_t const> bufs, lt::piece_index_t co
 
     buffers[pieces[piece].bi].accessed = std::chrono::system_clock::now();
 
+    // Piece could be faulted in from the spill file, taking one more buffer.
+    if (buffer_used >= buffer_limit) {
+        trim(piece);
+    }
+
     return n;
 };
 
 int memory_storage::writev(lt::span<lt::iovec_t const> bufs, lt::piece_index_t const pi, int offset, lt::open_mode_t  /*mode*/,
-            lt::storage_error & /*ec*/) {
+            lt::storage_error &ec) {
     auto piece = static_cast<int>(pi);
     if (is_logging) {
         OATPP_LOGI("memory_storage::writev", "writev in  p: %d, off: %d, bufs: %d", piece, offset, bufs.size());
@@ -186,7 +248,12 @@ int memory_storage::writev(lt::span<lt::iovec_t const> bufs, lt::piece_index_t c
         size += b.size();
 
         int const to_copy = std::min(std::size_t(pieces[piece].length) - file_offset, std::size_t(b.size()));
-        std::memcpy(&buffers[pieces[piece].bi].buffer[file_offset], b.data(), to_copy);
+        auto err = write_buffer(pieces[piece].bi, b.data(), file_offset, to_copy);
+        if (err) {
+            ec.ec = err;
+            ec.operation = lt::operation_t::file_write;
+            return -1;
+        }
 
         file_offset += to_copy;
         n += to_copy;
@@ -195,7 +262,7 @@ int memory_storage::writev(lt::span<lt::iovec_t const> bufs, lt::piece_index_t c
     if (is_logging) {
         OATPP_LOGI("memory_storage::writev", "writev out p: %d, pl: %d, bufs: %d / %d, req: %d, off: %d, bs: %d, res: %d=%d",
                     piece, pieces[piece].length, bufs.size(), bufs[0].size(), size, offset,
-                    buffers[pieces[piece].bi].buffer.size(), size, n);
+                    buffers[pieces[piece].bi].length, size, n);
     };
 
     pieces[piece].size += n;
@@ -234,6 +301,15 @@ void memory_storage::set_torrent_handle(const lt::torrent_handle& th) {
     m_handle = th.native_handle();
 
     is_handled = true;
+
+    auto &config = lh::config();
+    if (config.spill_size > 0 && spill == nullptr && is_spillable()) {
+        auto path = path_append(config.spill_path.empty() ? config.download_path : config.spill_path,
+                                to_hex(th.info_hash()) + ".spill");
+        spill.reset(new spill_cache(path, piece_count, piece_length, std::int64_t(config.spill_size) * 1024 * 1024));
+        if (!spill->is_open())
+            spill.reset();
+    }
 }
 
 void memory_storage::set_file_priority(lt::aux::vector<lt::download_priority_t, lt::file_index_t> & /*prio*/, lt::storage_error & /*ec*/) {}
@@ -256,7 +332,10 @@ bool memory_storage::get_buffer(memory_piece *p, bool is_write) {
         // Trying to lock and get to make sure we are not affected
         // by write/read at the same time.
         std::lock_guard<std::mutex> guard(m_mutex);
-        return p->is_buffered();
+        if (p->is_buffered())
+            return true;
+
+        return load_spilled_piece(p);
     }
 
     std::lock_guard<std::mutex> guard(m_mutex);
@@ -271,6 +350,10 @@ bool memory_storage::get_buffer(memory_piece *p, bool is_write) {
         return false;
     }
 
+    return assign_buffer(p);
+};
+
+bool memory_storage::assign_buffer(memory_piece *p) {
     for (int i = 0; i < buffer_size; i++) {
         if (buffers[i].is_used) {
             continue;
@@ -290,6 +373,9 @@ bool memory_storage::get_buffer(memory_piece *p, bool is_write) {
         // limit, to properly check for the usage.
         if (reserved_pieces.test(p->index)) {
             buffer_limit--;
+        } else if (pinned_pieces.test(p->index)) {
+            buffers[i].is_pinned = true;
+            buffer_limit--;
         } else {
             buffer_used++;
         };
@@ -305,6 +391,8 @@ void memory_storage::trim(int pi) {
         return;
     };
 
+    expire_pins();
+
     std::lock_guard<std::mutex> guard(m_mutex);
 
     while (buffer_used >= buffer_limit) {
@@ -324,7 +412,27 @@ void memory_storage::trim(int pi) {
             }
         }
 
-        int bi = find_last_buffer(pi, false);
+        // Reader pieces are removed from idle readers first, then from readers
+        //  that take more than their fair share of buffers.
+        int bi = find_unowned_buffer(pi);
+        if (bi != -1) {
+            if (is_logging) {
+                OATPP_LOGI("memory_storage::trim", "Removing idle reader piece: %d, buffer: %d", buffers[bi].pi, bi);
+            };
+            remove_piece(bi);
+            continue;
+        }
+
+        bi = find_over_quota_buffer(pi);
+        if (bi != -1) {
+            if (is_logging) {
+                OATPP_LOGI("memory_storage::trim", "Removing over quota piece: %d, buffer: %d", buffers[bi].pi, bi);
+            };
+            remove_piece(bi);
+            continue;
+        }
+
+        bi = find_last_buffer(pi, false);
         if (bi != -1) {
             if (is_logging) {
                 OATPP_LOGI("memory_storage::trim", "Removing LRU piece: %d, buffer: %d", buffers[bi].pi, bi);
@@ -332,6 +440,9 @@ void memory_storage::trim(int pi) {
             remove_piece(bi);
             continue;
         }
+
+        // Everything left is reserved or pinned, nothing to evict.
+        break;
     }
 };
 
@@ -354,8 +465,8 @@ int memory_storage::find_last_buffer(int pi, bool check_read) {
     std::lock_guard<std::mutex> guard(r_mutex);
 
     for (auto &buffer : buffers) {
-        if (buffer.is_used && buffer.is_assigned() && !is_reserved(buffer.pi) && buffer.pi != pi &&
-            (!check_read || !is_readered(buffer.pi)) && buffer.accessed < minTime) {
+        if (is_evictable(buffer, pi) && (!check_read || (!is_readered(buffer.pi) && !is_owned(buffer.pi))) &&
+            buffer.accessed < minTime) {
             bi = buffer.index;
             minTime = buffer.accessed;
         };
@@ -364,18 +475,186 @@ int memory_storage::find_last_buffer(int pi, bool check_read) {
     return bi;
 }
 
+int memory_storage::find_unowned_buffer(int pi) {
+    int bi = -1;
+    std::chrono::time_point<std::chrono::system_clock> minTime = std::chrono::system_clock::now();
+    std::lock_guard<std::mutex> guard(r_mutex);
+
+    if (reader_windows.empty())
+        return bi;
+
+    for (auto &buffer : buffers) {
+        if (!is_evictable(buffer, pi) || buffer.accessed >= minTime)
+            continue;
+
+        if (!is_owned(buffer.pi)) {
+            bi = buffer.index;
+            minTime = buffer.accessed;
+        }
+    };
+
+    return bi;
+}
+
+int memory_storage::find_over_quota_buffer(int pi) {
+    int bi = -1;
+    int max_excess = 0;
+    std::lock_guard<std::mutex> guard(r_mutex);
+
+    if (reader_windows.empty())
+        return bi;
+
+    // Each active reader is guaranteed an equal share of buffers for its window.
+    int quota = std::max(1, buffer_limit / int(reader_windows.size()));
+
+    for (auto &w : reader_windows) {
+        int used = 0;
+        int lru = -1;
+        std::chrono::time_point<std::chrono::system_clock> minTime = std::chrono::system_clock::now();
+
+        for (auto &buffer : buffers) {
+            if (!is_evictable(buffer, pi) || !w.second.test(buffer.pi))
+                continue;
+
+            used++;
+            if (buffer.accessed < minTime) {
+                lru = buffer.index;
+                minTime = buffer.accessed;
+            }
+        }
+
+        if (lru != -1 && used - quota > max_excess) {
+            max_excess = used - quota;
+            bi = lru;
+        }
+    }
+
+    return bi;
+}
+
+bool memory_storage::is_owned(int index) const {
+    return std::any_of(reader_windows.begin(), reader_windows.end(),
+                       [index](const std::pair<const std::int64_t, Bitset> &w) { return w.second.test(index); });
+}
+
+bool memory_storage::is_evictable(const memory_buffer &buffer, int pi) const {
+    return buffer.is_used && buffer.is_assigned() && !is_reserved(buffer.pi) && !is_pinned(buffer.pi) && buffer.pi != pi;
+}
+
 void memory_storage::remove_piece(int bi) {
     int pi = buffers[bi].pi;
+    bool is_spilled = pi != -1 && pi < piece_count && spill_piece(bi);
 
     buffers[bi].reset();
     buffer_used--;
 
     if (pi != -1 && pi < piece_count) {
         pieces[pi].reset();
-        restore_piece(pi);
+
+        // Spilled piece is still available, so there is no need to download it again.
+        if (!is_spilled)
+            restore_piece(pi);
     }
 }
 
+bool memory_storage::spill_piece(int bi) {
+    if (spill == nullptr || !is_handled)
+        return false;
+
+    // Only verified pieces can be served back without a re-check.
+    int pi = buffers[bi].pi;
+    if (!m_handle->have_piece(lt::piece_index_t(pi)))
+        return false;
+
+    int evicted = -1;
+    bool is_stored = spill->store(pi, buffers[bi].buffer.data(), pieces[pi].length, evicted);
+
+    // Piece, evicted from the spill file, is gone from both places, so it has to be downloaded again.
+    if (evicted != -1 && !pieces[evicted].is_buffered())
+        restore_piece(evicted);
+
+    if (!is_stored)
+        return false;
+
+    if (is_logging) {
+        OATPP_LOGI("memory_storage::spill_piece", "Spilled piece: %d, evicted from spill: %d", pi, evicted);
+    };
+
+    return true;
+}
+
+bool memory_storage::load_spilled_piece(memory_piece *p) {
+    if (spill == nullptr || !spill->has(p->index))
+        return false;
+
+    if (!assign_buffer(p))
+        return false;
+
+    if (!spill->load(p->index, buffers[p->bi].buffer.data(), p->length)) {
+        int bi = p->bi;
+        if (buffers[bi].is_pinned || reserved_pieces.test(p->index))
+            buffer_limit++;
+        else
+            buffer_used--;
+
+        buffers[bi].reset();
+        p->reset();
+        restore_piece(p->index);
+        return false;
+    }
+
+    if (is_logging) {
+        OATPP_LOGI("memory_storage::load_spilled_piece", "Loaded piece %d from spill", p->index);
+    };
+
+    p->size = p->length;
+    return true;
+}
+
+bool memory_storage::copy_piece(int pi, std::vector<char> &data) {
+    if (!is_initialized || pi < 0 || pi >= piece_count)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!pieces[pi].is_buffered())
+        return false;
+
+    data.resize(pieces[pi].length);
+    return !read_buffer(pieces[pi].bi, data.data(), 0, pieces[pi].length);
+}
+
+int memory_storage::get_shared_fd() const { return -1; }
+
+std::vector<std::pair<int, int>> memory_storage::get_piece_slots() {
+    std::vector<std::pair<int, int>> result;
+    if (!is_initialized || !is_handled)
+        return result;
+
+    std::vector<std::pair<int, int>> slots;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (const auto &buffer : buffers) {
+            if (buffer.is_used && buffer.is_assigned())
+                slots.emplace_back(buffer.pi, buffer.index);
+        }
+    }
+
+    // Verified pieces are taken with one status query outside of the lock, so disk reads and writes are not stalled.
+    auto verified = m_torrent.status(lt::torrent_handle::query_pieces).pieces;
+    for (const auto &s : slots) {
+        if (s.first < verified.size() && verified.get_bit(lt::piece_index_t(s.first)))
+            result.push_back(s);
+    }
+
+    return result;
+}
+
+int memory_storage::get_spill_count() const { return spill != nullptr ? spill->get_used_count() : 0; }
+
+int memory_storage::get_spill_limit() const { return spill != nullptr ? spill->get_slot_count() : 0; }
+
+std::int64_t memory_storage::get_spill_saved() const { return spill != nullptr ? spill->get_bytes_saved() : 0; }
+
 void memory_storage::restore_piece(int pi) {
     if (!is_handled)
         return;
@@ -408,7 +687,7 @@ void memory_storage::enable_logging() { is_logging = true; }
 
 void memory_storage::disable_logging() { is_logging = false; }
 
-void memory_storage::update_reader_pieces(const std::vector<int>& pieces) {
+void memory_storage::update_reader_pieces(const std::vector<int>& pieces, const std::map<std::int64_t, std::vector<int>>& windows) {
     if (!is_initialized)
         return;
 
@@ -417,6 +696,15 @@ void memory_storage::update_reader_pieces(const std::vector<int>& pieces) {
     for (int piece : pieces) {
         reader_pieces.set(piece);
     };
+
+    reader_windows.clear();
+    for (const auto &w : windows) {
+        Bitset window(piece_count + 10);
+        for (int piece : w.second) {
+            window.set(piece);
+        }
+        reader_windows[w.first] = window;
+    };
 };
 
 void memory_storage::update_reserved_pieces(const std::vector<int>& pieces) {
@@ -451,8 +739,120 @@ bool memory_storage::is_readered(int index) {
     return m_handle->piece_priority(lt::piece_index_t(index)) != lt::download_priority_t(0);
 };
 
+bool memory_storage::pin_pieces(const std::string &owner, int start, int end, std::chrono::seconds ttl) {
+    if (!is_initialized)
+        return false;
+
+    start = std::max(0, start);
+    end = std::min(piece_count - 1, end);
+    if (start > end)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::lock_guard<std::mutex> r_guard(r_mutex);
+
+    pins.erase(std::remove_if(pins.begin(), pins.end(), [](const memory_pin &p) { return p.is_expired(); }), pins.end());
+    rebuild_pinned_pieces();
+    update_pinned_buffers();
+
+    // Count what pinned set would be after adding new range, to stay within the budget.
+    Bitset requested = pinned_pieces;
+    for (int i = start; i <= end; i++) {
+        requested.set(i);
+    }
+    if (int(requested.count()) > pinned_limit) {
+        OATPP_LOGI("memory_storage::pin_pieces", "Not pinning pieces %d-%d for '%s': %d pieces exceed limit of %d", start, end,
+                    owner.c_str(), int(requested.count()), pinned_limit);
+        return false;
+    }
+
+    pins.emplace_back(owner, start, end, ttl);
+    OATPP_LOGI("memory_storage::pin_pieces", "Pinned pieces %d-%d for '%s' (ttl: %ds)", start, end, owner.c_str(), int(ttl.count()));
+
+    rebuild_pinned_pieces();
+    update_pinned_buffers();
+    return true;
+};
+
+void memory_storage::unpin_pieces(const std::string &owner, int start, int end) {
+    if (!is_initialized)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::lock_guard<std::mutex> r_guard(r_mutex);
+
+    pins.erase(std::remove_if(pins.begin(), pins.end(),
+                              [&](const memory_pin &p) {
+                                  return p.is_expired() || (p.owner == owner && p.piece_start <= end && p.piece_end >= start);
+                              }),
+               pins.end());
+
+    rebuild_pinned_pieces();
+    update_pinned_buffers();
+};
+
+void memory_storage::expire_pins() {
+    if (!is_initialized)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::lock_guard<std::mutex> r_guard(r_mutex);
+
+    auto size = pins.size();
+    pins.erase(std::remove_if(pins.begin(), pins.end(), [](const memory_pin &p) { return p.is_expired(); }), pins.end());
+    if (size == pins.size())
+        return;
+
+    if (is_logging) {
+        OATPP_LOGI("memory_storage::expire_pins", "Expired %d pins", int(size - pins.size()));
+    };
+
+    rebuild_pinned_pieces();
+    update_pinned_buffers();
+};
+
+bool memory_storage::is_pinned(int index) const {
+    if (!is_initialized)
+        return false;
+
+    return pinned_pieces.test(index);
+};
+
+int memory_storage::get_pinned_count() const { return int(pinned_pieces.count()); };
+
+int memory_storage::get_pinned_limit() const { return pinned_limit; };
+
+void memory_storage::rebuild_pinned_pieces() {
+    pinned_pieces.reset();
+    for (const auto &pin : pins) {
+        for (int i = pin.piece_start; i <= pin.piece_end; i++) {
+            pinned_pieces.set(i);
+        }
+    }
+};
+
+void memory_storage::update_pinned_buffers() {
+    // Pinned buffers live outside of the LRU limit, so moving a buffer in or out
+    // of the pinned set should move it between limit and usage counters.
+    for (auto &buffer : buffers) {
+        if (!buffer.is_used || !buffer.is_assigned() || reserved_pieces.test(buffer.pi))
+            continue;
+
+        bool should_pin = pinned_pieces.test(buffer.pi);
+        if (should_pin && !buffer.is_pinned) {
+            buffer.is_pinned = true;
+            buffer_used--;
+            buffer_limit--;
+        } else if (!should_pin && buffer.is_pinned) {
+            buffer.is_pinned = false;
+            buffer_used++;
+            buffer_limit++;
+        }
+    }
+};
+
 lt::storage_interface* memory_storage_constructor(lt::storage_params const &params, lt::file_pool & /*unused*/) {
-    return new memory_storage(params);
+    return new memory_storage(params, lh::memory_size);
 }
 
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <cmath>
 #include <cstdint>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -25,10 +26,12 @@
 #include <libtorrent/torrent.hpp>
 #include <libtorrent/torrent_handle.hpp>
 #include <libtorrent/torrent_info.hpp>
+#include <libtorrent/torrent_status.hpp>
 #include <libtorrent/units.hpp>
 #include <utility>
 
 #include <app/config.h>
+#include <bittorrent/spill_cache.h>
 
 #include <utils/numbers.h>
 #include <utils/strings.h>
@@ -62,22 +65,42 @@ struct memory_buffer {
 
     int pi;
     bool is_used;
+    bool is_pinned;
     std::chrono::time_point<std::chrono::system_clock> accessed;
 
-    memory_buffer(int index, int length);
+    memory_buffer(int index, int length, bool is_allocated = true);
 
     bool is_assigned() const;
 
     void reset();
 };
 
+struct memory_pin {
+  public:
+    std::string owner;
+    int piece_start;
+    int piece_end;
+
+    bool is_expiring;
+    std::chrono::time_point<std::chrono::system_clock> expires;
+
+    memory_pin(std::string owner, int piece_start, int piece_end, std::chrono::seconds ttl);
+
+    bool is_expired() const;
+};
+
 struct memory_storage : lt::storage_interface {
-  private:
+  protected:
     std::mutex m_mutex;
     std::mutex r_mutex;
 
     Bitset reader_pieces;
     Bitset reserved_pieces;
+    Bitset pinned_pieces;
+    std::map<std::int64_t, Bitset> reader_windows;
+
+    std::vector<memory_pin> pins;
+    int pinned_limit;
 
     std::string id;
     std::int64_t capacity;
@@ -92,6 +115,8 @@ struct memory_storage : lt::storage_interface {
     int buffer_reserved;
     std::vector<memory_buffer> buffers;
 
+    std::unique_ptr<spill_cache> spill;
+
     lt::file_storage m_files;
     std::shared_ptr<lt::torrent> m_handle;
     lt::torrent_handle m_torrent;
@@ -101,8 +126,16 @@ struct memory_storage : lt::storage_interface {
     bool is_reading;
     bool is_handled;
 
+    virtual lt::error_code create_buffers(int start, int end);
+
+    virtual lt::error_code read_buffer(int bi, char *data, int offset, int length);
+
+    virtual lt::error_code write_buffer(int bi, const char *data, int offset, int length);
+
+    virtual bool is_spillable() const;
+
   public:
-    explicit memory_storage(lt::storage_params const &params);
+    memory_storage(lt::storage_params const &params, std::int64_t size);
 
     void initialize(lt::storage_error &ec) override;
 
@@ -151,12 +184,38 @@ struct memory_storage : lt::storage_interface {
 
     bool get_buffer(memory_piece *p, bool is_write);
 
+    bool assign_buffer(memory_piece *p);
+
+    bool spill_piece(int bi);
+
+    bool load_spilled_piece(memory_piece *p);
+
+    bool copy_piece(int pi, std::vector<char> &data);
+
+    virtual int get_shared_fd() const;
+
+    std::vector<std::pair<int, int>> get_piece_slots();
+
+    int get_spill_count() const;
+
+    int get_spill_limit() const;
+
+    std::int64_t get_spill_saved() const;
+
     void trim(int pi);
 
     std::string get_buffer_info();
 
     int find_last_buffer(int pi, bool check_read);
 
+    int find_unowned_buffer(int pi);
+
+    int find_over_quota_buffer(int pi);
+
+    bool is_evictable(const memory_buffer &buffer, int pi) const;
+
+    bool is_owned(int index) const;
+
     void remove_piece(int bi);
 
     void restore_piece(int pi);
@@ -165,13 +224,29 @@ struct memory_storage : lt::storage_interface {
 
     void disable_logging();
 
-    void update_reader_pieces(const std::vector<int>& pieces);
+    void update_reader_pieces(const std::vector<int>& pieces, const std::map<std::int64_t, std::vector<int>>& windows = {});
 
     void update_reserved_pieces(const std::vector<int>& pieces);
 
     bool is_reserved(int index) const;
 
     bool is_readered(int index);
+
+    bool pin_pieces(const std::string &owner, int start, int end, std::chrono::seconds ttl);
+
+    void unpin_pieces(const std::string &owner, int start, int end);
+
+    void expire_pins();
+
+    bool is_pinned(int index) const;
+
+    int get_pinned_count() const;
+
+    int get_pinned_limit() const;
+
+    void rebuild_pinned_pieces();
+
+    void update_pinned_buffers();
 };
 
 lt::storage_interface *memory_storage_constructor(lt::storage_params const &params, lt::file_pool &);
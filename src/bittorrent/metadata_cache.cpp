@@ -0,0 +1,170 @@
+#include "metadata_cache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <oatpp/core/base/Environment.hpp>
+
+#include <utils/path.h>
+#include <utils/strings.h>
+
+namespace fs = boost::filesystem;
+
+namespace lh {
+
+// Parsed metadata of large torrents is big, so memory keeps only a few of them.
+const int memoryEntries = 16;
+
+metadata_cache::metadata_cache(std::string path, int size) : path(std::move(path)), capacity(size) {
+    auto ec = mkpath(this->path);
+    if (ec) {
+        OATPP_LOGE("metadata_cache", "Failed to create cache directory at %s: %s", this->path.c_str(), ec.message().c_str());
+        capacity = 0;
+        return;
+    }
+
+    scan();
+    trim();
+
+    OATPP_LOGI("metadata_cache", "Using metadata cache at '%s' with %d of %d torrents", this->path.c_str(), int(entries.size()),
+                capacity);
+}
+
+std::string metadata_cache::entry_path(const std::string &hash) const { return path_append(path, hash + ".torrent"); }
+
+void metadata_cache::scan() {
+    boost::system::error_code ec;
+    for (fs::directory_iterator it(path, ec), end; it != end && !ec; it.increment(ec)) {
+        if (!fs::is_regular_file(it->path(), ec))
+            continue;
+
+        // Temporary files are left only by interrupted writes.
+        if (it->path().extension() == ".tmp") {
+            fs::remove(it->path(), ec);
+            continue;
+        }
+
+        if (it->path().extension() != ".torrent")
+            continue;
+
+        entries[it->path().stem().string()] = metadata_cache_entry{nullptr, fs::last_write_time(it->path(), ec)};
+    }
+}
+
+void metadata_cache::trim() {
+    while (int(entries.size()) > capacity && !entries.empty()) {
+        auto lru = std::min_element(entries.begin(), entries.end(),
+                                    [](const std::pair<const std::string, metadata_cache_entry> &a,
+                                       const std::pair<const std::string, metadata_cache_entry> &b) { return a.second.accessed < b.second.accessed; });
+        erase(lru->first);
+    }
+}
+
+void metadata_cache::trim_memory() {
+    for (;;) {
+        auto lru = entries.end();
+        int loaded = 0;
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second.info == nullptr)
+                continue;
+
+            loaded++;
+            if (lru == entries.end() || it->second.accessed < lru->second.accessed)
+                lru = it;
+        }
+
+        if (loaded <= memoryEntries)
+            return;
+        lru->second.info = nullptr;
+    }
+}
+
+void metadata_cache::erase(const std::string &hash) {
+    boost::system::error_code ec;
+    fs::remove(entry_path(hash), ec);
+
+    entries.erase(hash);
+}
+
+bool metadata_cache::get(const std::string &hash, std::shared_ptr<lt::torrent_info> &ti) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto it = entries.find(hash);
+    if (it == entries.end())
+        return false;
+
+    auto file_path = entry_path(hash);
+    if (it->second.info == nullptr) {
+        lt::error_code ec;
+        auto info = std::make_shared<const lt::torrent_info>(file_path, ec);
+        if (ec) {
+            OATPP_LOGE("metadata_cache::get", "Failed to load metadata %s: %s", hash.c_str(), ec.message().c_str());
+            erase(hash);
+            return false;
+        }
+
+        // Renamed or corrupted file would start the magnet with metadata of another torrent.
+        if (to_hex(info->info_hash()) != hash) {
+            OATPP_LOGE("metadata_cache::get", "Cached metadata %s has info hash %s", hash.c_str(), to_hex(info->info_hash()).c_str());
+            erase(hash);
+            return false;
+        }
+
+        it->second.info = info;
+    }
+
+    // Access time is kept in modification time, so LRU order survives restarts.
+    boost::system::error_code ec;
+    it->second.accessed = std::time(nullptr);
+    fs::last_write_time(file_path, it->second.accessed, ec);
+
+    // Torrent gets its own copy, since libtorrent modifies torrent_info of a running torrent.
+    ti = std::make_shared<lt::torrent_info>(*it->second.info);
+    trim_memory();
+    return true;
+}
+
+void metadata_cache::put(const std::string &hash, const lt::torrent_info &ti) {
+    if (capacity <= 0 || !ti.is_valid() || ti.metadata_size() <= 0)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (entries.find(hash) != entries.end())
+        return;
+
+    // Info dictionary is wrapped into a minimal torrent file, which is enough to restore metadata.
+    std::vector<char> data;
+    const std::string prefix = "d4:info";
+    data.insert(data.end(), prefix.begin(), prefix.end());
+    data.insert(data.end(), ti.metadata().get(), ti.metadata().get() + ti.metadata_size());
+    data.push_back('e');
+
+    boost::system::error_code ec;
+    auto file_path = entry_path(hash);
+    auto tmp_path = file_path + ".tmp";
+    if (!save_file(tmp_path, data)) {
+        fs::remove(tmp_path, ec);
+        return;
+    }
+
+    fs::rename(tmp_path, file_path, ec);
+    if (ec) {
+        OATPP_LOGE("metadata_cache::put", "Failed to store metadata %s: %s", hash.c_str(), ec.message().c_str());
+        fs::remove(tmp_path, ec);
+        return;
+    }
+
+    entries[hash] = metadata_cache_entry{std::make_shared<const lt::torrent_info>(ti), std::time(nullptr)};
+    trim();
+    trim_memory();
+}
+
+int metadata_cache::get_count() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return int(entries.size());
+}
+
+} // namespace lh
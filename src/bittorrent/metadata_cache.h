@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <libtorrent/torrent_info.hpp>
+
+namespace lh {
+
+struct metadata_cache_entry {
+  public:
+    std::shared_ptr<const lt::torrent_info> info;
+    std::time_t accessed;
+};
+
+// Cache of resolved magnet metadata, so a magnet added again starts without metadata exchange.
+//  All entries are kept as '<path>/<info hash>.torrent', only recently used ones are also kept in memory.
+struct metadata_cache {
+  private:
+    std::mutex m_mutex;
+
+    std::string path;
+    int capacity;
+
+    std::map<std::string, metadata_cache_entry> entries;
+
+    std::string entry_path(const std::string &hash) const;
+
+    void scan();
+    void trim();
+    void trim_memory();
+    void erase(const std::string &hash);
+
+  public:
+    metadata_cache(std::string path, int size);
+
+    bool get(const std::string &hash, std::shared_ptr<lt::torrent_info> &ti);
+
+    void put(const std::string &hash, const lt::torrent_info &ti);
+
+    int get_count();
+};
+
+} // namespace lh
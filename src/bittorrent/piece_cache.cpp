@@ -0,0 +1,155 @@
+#include "piece_cache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#include <boost/filesystem.hpp>
+
+#include <oatpp/core/base/Environment.hpp>
+
+#include <utils/numbers.h>
+#include <utils/path.h>
+
+namespace fs = boost::filesystem;
+
+namespace lh {
+
+piece_cache::piece_cache(std::string path, std::int64_t size) : path(std::move(path)), capacity(size), used(0) {
+    auto ec = mkpath(this->path);
+    if (ec) {
+        OATPP_LOGE("piece_cache", "Failed to create cache directory at %s: %s", this->path.c_str(), ec.message().c_str());
+        capacity = 0;
+        return;
+    }
+
+    scan();
+    trim();
+
+    OATPP_LOGI("piece_cache", "Using piece cache at '%s' with %d pieces, %s of %s", this->path.c_str(), int(entries.size()),
+                humanize_bytes(used).c_str(), humanize_bytes(capacity).c_str());
+}
+
+std::string piece_cache::entry_key(const std::string &hash, int pi) const { return hash + "/" + std::to_string(pi); }
+
+std::string piece_cache::entry_path(const std::string &key) const { return path_append(path, key); }
+
+void piece_cache::scan() {
+    boost::system::error_code ec;
+    for (fs::recursive_directory_iterator it(path, ec), end; it != end && !ec; it.increment(ec)) {
+        if (!fs::is_regular_file(it->path(), ec))
+            continue;
+
+        // Temporary files are left only by interrupted writes.
+        if (it->path().extension() == ".tmp") {
+            fs::remove(it->path(), ec);
+            continue;
+        }
+
+        auto key = it->path().parent_path().filename().string() + "/" + it->path().filename().string();
+        auto size = std::int64_t(fs::file_size(it->path(), ec));
+        if (ec)
+            continue;
+
+        entries[key] = piece_cache_entry{size, fs::last_write_time(it->path(), ec)};
+        used += size;
+    }
+}
+
+void piece_cache::trim() {
+    while (used > capacity && !entries.empty()) {
+        auto lru = std::min_element(entries.begin(), entries.end(),
+                                    [](const std::pair<const std::string, piece_cache_entry> &a,
+                                       const std::pair<const std::string, piece_cache_entry> &b) { return a.second.accessed < b.second.accessed; });
+        erase(lru->first);
+    }
+}
+
+void piece_cache::erase(const std::string &key) {
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return;
+
+    boost::system::error_code ec;
+    fs::remove(entry_path(key), ec);
+
+    used -= it->second.size;
+    entries.erase(it);
+}
+
+bool piece_cache::has(const std::string &hash, int pi) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return entries.find(entry_key(hash, pi)) != entries.end();
+}
+
+bool piece_cache::load(const std::string &hash, int pi, std::vector<char> &data) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto key = entry_key(hash, pi);
+    auto it = entries.find(key);
+    if (it == entries.end())
+        return false;
+
+    auto file_path = entry_path(key);
+    if (!load_file(file_path, data, int(it->second.size)) || std::int64_t(data.size()) != it->second.size) {
+        erase(key);
+        return false;
+    }
+
+    // Access time is kept in modification time, so LRU order survives restarts.
+    boost::system::error_code ec;
+    it->second.accessed = std::time(nullptr);
+    fs::last_write_time(file_path, it->second.accessed, ec);
+    return true;
+}
+
+void piece_cache::store(const std::string &hash, int pi, const char *data, int length) {
+    if (capacity <= 0 || length > capacity)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto key = entry_key(hash, pi);
+    if (entries.find(key) != entries.end())
+        return;
+
+    boost::system::error_code ec;
+    fs::create_directories(path_append(path, hash), ec);
+
+    auto file_path = entry_path(key);
+    auto tmp_path = file_path + ".tmp";
+    if (!save_file(tmp_path, data, std::size_t(length))) {
+        fs::remove(tmp_path, ec);
+        return;
+    }
+
+    fs::rename(tmp_path, file_path, ec);
+    if (ec) {
+        OATPP_LOGE("piece_cache::store", "Failed to store piece %s: %s", key.c_str(), ec.message().c_str());
+        fs::remove(tmp_path, ec);
+        return;
+    }
+
+    entries[key] = piece_cache_entry{length, std::time(nullptr)};
+    used += length;
+    trim();
+}
+
+void piece_cache::remove(const std::string &hash, int pi) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    erase(entry_key(hash, pi));
+}
+
+std::int64_t piece_cache::get_capacity() const { return capacity; }
+
+std::int64_t piece_cache::get_used() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return used;
+}
+
+int piece_cache::get_count() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return int(entries.size());
+}
+
+} // namespace lh
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ctime>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lh {
+
+struct piece_cache_entry {
+  public:
+    std::int64_t size;
+    std::time_t accessed;
+};
+
+// Persistent on-disk cache of verified pieces, shared by all memory storage torrents.
+//  Pieces are stored as '<path>/<info hash>/<piece index>', which is written to a temporary
+//  file and renamed, so a crash never leaves a partial piece under its final name.
+struct piece_cache {
+  private:
+    std::mutex m_mutex;
+
+    std::string path;
+    std::int64_t capacity;
+    std::int64_t used;
+
+    std::map<std::string, piece_cache_entry> entries;
+
+    std::string entry_key(const std::string &hash, int pi) const;
+    std::string entry_path(const std::string &key) const;
+
+    void scan();
+    void trim();
+    void erase(const std::string &key);
+
+  public:
+    piece_cache(std::string path, std::int64_t size);
+
+    bool has(const std::string &hash, int pi);
+
+    bool load(const std::string &hash, int pi, std::vector<char> &data);
+
+    void store(const std::string &hash, int pi, const char *data, int length);
+
+    void remove(const std::string &hash, int pi);
+
+    std::int64_t get_capacity() const;
+
+    std::int64_t get_used();
+
+    int get_count();
+};
+
+} // namespace lh
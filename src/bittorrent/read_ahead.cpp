@@ -0,0 +1,168 @@
+#include "read_ahead.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <oatpp/core/base/Environment.hpp>
+
+#include <app/application.h>
+
+#include <utils/system.h>
+
+namespace lh {
+
+bool read_chunk::contains(std::int64_t position) const {
+    return is_ready && position >= offset && position < offset + size;
+}
+
+void read_chunk::reset() {
+    offset = -1;
+    size = 0;
+    is_pending = false;
+    is_ready = false;
+}
+
+ReadPool::ReadPool(int threads) {
+    OATPP_LOGI("ReadPool", "Starting %d disk read threads", threads);
+
+    for (int i = 0; i < threads; i++) {
+        m_threads.emplace_back([this] { work(); });
+    }
+}
+
+ReadPool::~ReadPool() {
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_isStopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto &t : m_threads) {
+        if (t.joinable())
+            t.join();
+    }
+}
+
+void ReadPool::work() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_isStopping || !m_jobs.empty(); });
+            if (m_isStopping)
+                return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job();
+    }
+}
+
+void ReadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_condition.notify_one();
+}
+
+ReadPool &ReadPool::get() {
+    static ReadPool pool(std::max(1, lh::config().read_threads));
+    return pool;
+}
+
+ReadAhead::ReadAhead(int fd, int chunk_count, int chunk_size) : m_fd(::dup(fd)), m_chunk_size(chunk_size), m_chunks(chunk_count) {}
+
+ReadAhead::~ReadAhead() {
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+int ReadAhead::take(std::int64_t position, char *buffer, int size) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    for (auto &chunk : m_chunks) {
+        if (!chunk.contains(position))
+            continue;
+
+        int start = int(position - chunk.offset);
+        int n = std::min(size, chunk.size - start);
+        std::memcpy(buffer, chunk.data.data() + start, n);
+
+        // Fully consumed chunk is released for next prefetch.
+        if (start + n >= chunk.size)
+            chunk.reset();
+
+        return n;
+    }
+
+    return 0;
+}
+
+void ReadAhead::schedule(std::int64_t position, std::int64_t limit) {
+    if (m_fd < 0)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // Chunks behind the reader will not be read anymore.
+    for (auto &chunk : m_chunks) {
+        if (chunk.is_ready && chunk.offset + chunk.size <= position)
+            chunk.reset();
+    }
+
+    std::int64_t offset = position / m_chunk_size * m_chunk_size;
+    for (std::size_t i = 0; i < m_chunks.size() && offset < limit; i++) {
+        // Skip chunks, that are already prefetched or queued.
+        bool is_known = true;
+        while (is_known && offset < limit) {
+            is_known = std::any_of(m_chunks.begin(), m_chunks.end(), [offset](const read_chunk &c) {
+                return (c.is_ready || c.is_pending) && c.offset == offset;
+            });
+            if (is_known)
+                offset += m_chunk_size;
+        }
+        if (offset >= limit)
+            break;
+
+        auto &chunk = m_chunks[i];
+        if (chunk.is_ready || chunk.is_pending)
+            continue;
+
+        int size = int(std::min(std::int64_t(m_chunk_size), limit - offset));
+        chunk.offset = offset;
+        chunk.size = size;
+        chunk.is_pending = true;
+
+        auto self = shared_from_this();
+        ReadPool::get().submit([self, i, offset, size] { self->fill(i, offset, size); });
+
+        offset += m_chunk_size;
+    }
+}
+
+void ReadAhead::fill(std::size_t index, std::int64_t offset, int size) {
+    std::vector<char> data(size);
+    auto n = read_at(m_fd, data.data(), std::size_t(size), offset);
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto &chunk = m_chunks[index];
+    if (!chunk.is_pending || chunk.offset != offset)
+        return;
+
+    if (n != size) {
+        chunk.reset();
+        return;
+    }
+
+    chunk.data.swap(data);
+    chunk.is_pending = false;
+    chunk.is_ready = true;
+}
+
+} // namespace lh
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lh {
+
+struct read_chunk {
+  public:
+    std::int64_t offset = -1;
+    int size = 0;
+    bool is_pending = false;
+    bool is_ready = false;
+    std::vector<char> data;
+
+    bool contains(std::int64_t position) const;
+
+    void reset();
+};
+
+// Worker pool, shared by all readers, that runs queued disk reads.
+class ReadPool {
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::function<void()>> m_jobs;
+    std::vector<std::thread> m_threads;
+    bool m_isStopping = false;
+
+    void work();
+
+  public:
+    explicit ReadPool(int threads);
+    ~ReadPool();
+
+    ReadPool(const ReadPool &) = delete;
+    ReadPool &operator=(const ReadPool &) = delete;
+
+    void submit(std::function<void()> job);
+
+    static ReadPool &get();
+};
+
+// Chunks of a file, prefetched ahead of a single reader by ReadPool and consumed by Reader::read.
+class ReadAhead : public std::enable_shared_from_this<ReadAhead> {
+  private:
+    std::mutex m_mutex;
+    int m_fd;
+    int m_chunk_size;
+    std::vector<read_chunk> m_chunks;
+
+    void fill(std::size_t index, std::int64_t offset, int size);
+
+  public:
+    ReadAhead(int fd, int chunk_count, int chunk_size);
+    ~ReadAhead();
+
+    ReadAhead(const ReadAhead &) = delete;
+    ReadAhead &operator=(const ReadAhead &) = delete;
+
+    int take(std::int64_t position, char *buffer, int size);
+
+    void schedule(std::int64_t position, std::int64_t limit);
+};
+
+} // namespace lh
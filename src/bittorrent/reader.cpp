@@ -1,11 +1,20 @@
 #include "reader.h"
 
+#include <app/application.h>
 #include <bittorrent/file.h>
 #include <bittorrent/torrent.h>
 
 #include <libtorrent/download_priority.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <utility>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <utils/system.h>
+
 namespace lh {
 
 Reader::Reader(std::shared_ptr<Torrent> torrent, std::shared_ptr<File> file, oatpp::web::protocol::http::Range range)
@@ -14,6 +23,7 @@ Reader::Reader(std::shared_ptr<Torrent> torrent, std::shared_ptr<File> file, oat
     OATPP_LOGI("Reader", "Creating reader for file: %s (%s)", m_file->path().c_str(), std::to_string(m_id).c_str());
 
     m_offset = m_file->offset();
+    m_accessed = std::chrono::system_clock::now().time_since_epoch().count();
     m_position = m_range.start;
     m_piece_size = m_torrent->piece_length();
     m_piece_start = piece_from_offset(m_range.start);
@@ -25,15 +35,27 @@ Reader::~Reader() {
 
     m_isClosing = true;
 
+    if (m_fd >= 0)
+        ::close(m_fd);
+
     // Unregister reader from parent objects
     m_file->unregister_reader(m_id);
     m_torrent->unregister_reader(m_id);
+    m_torrent->release_sidecars(m_file);
 }
 
 std::int64_t Reader::id() const {
     return m_id;
 };
 
+std::shared_ptr<File> Reader::file() const {
+    return m_file;
+};
+
+std::int64_t Reader::position() const {
+    return m_position;
+};
+
 int Reader::piece_start() const {
     return m_piece_start;
 };
@@ -46,10 +68,28 @@ int Reader::piece_end_limit() const {
     return m_file->piece_end();
 };
 
+int Reader::piece_retention_start() const {
+    std::int64_t retention = std::int64_t(lh::config().retention_size) * 1024 * 1024;
+    return piece_from_offset(std::max(std::int64_t(0), m_position - retention));
+};
+
 bool Reader::is_closing() const {
     return m_isClosing;
 };
 
+bool Reader::is_idle() const {
+    return std::chrono::system_clock::now() - accessed() > m_idle_timeout;
+};
+
+std::chrono::time_point<std::chrono::system_clock> Reader::accessed() const {
+    return std::chrono::time_point<std::chrono::system_clock>(std::chrono::system_clock::duration(m_accessed.load()));
+};
+
+void Reader::close() {
+    OATPP_LOGI("Reader", "Closing: %s (%s)", m_file->path().c_str(), std::to_string(m_id).c_str());
+    m_isClosing = true;
+};
+
 bool Reader::is_iterated() const {
     return m_isIterated;
 };
@@ -63,7 +103,9 @@ oatpp::v_io_size Reader::read(void *buffer, v_buff_size bufferSize, oatpp::async
 
     (void)action;
 
-    if (m_position >= m_file->size())
+    m_accessed = std::chrono::system_clock::now().time_since_epoch().count();
+
+    if (m_isClosing || m_position >= m_file->size())
         return 0;
 
     m_piece_start = piece_from_offset(m_position);
@@ -80,14 +122,27 @@ oatpp::v_io_size Reader::read(void *buffer, v_buff_size bufferSize, oatpp::async
     int left = bufferSize;
     lt::iovec_t b = {(char *)buffer, left};
 
+    // File storage is read directly from the downloaded file, which goes through the page cache
+    //  and does not need libtorrent's file pool for every chunk.
+    bool is_direct = !m_torrent->is_memory_storage() && open_file();
+    std::int64_t available = std::min(std::int64_t(bufferSize), m_file->size() - m_position);
+
     for (int p = m_piece_start; p <= m_piece_end; ++p) {
         if (!m_torrent->have_piece(p)) {
             wait_for_piece(p);
-            if (m_isClosing || m_torrent->is_closing() || !m_torrent->have_piece(p))
-                return ret;
+            if (m_isClosing || m_torrent->is_closing() || !m_torrent->have_piece(p)) {
+                if (!is_direct)
+                    return ret;
+
+                available = std::min(available, piece_offset(p) - m_position);
+                break;
+            }
         }
         m_torrent->clear_piece_deadline(p);
 
+        if (is_direct)
+            continue;
+
         if (ret > 0)
             b = b.subspan(bufferSize-left);
 
@@ -102,6 +157,20 @@ oatpp::v_io_size Reader::read(void *buffer, v_buff_size bufferSize, oatpp::async
         ret += n;
     } 
 
+    if (is_direct && available > 0) {
+        ret = read_file((char *)buffer, int(available));
+        if (ret < 0)
+            return 0;
+
+        m_position += ret;
+        advise_file();
+
+        if (m_readahead != nullptr)
+            m_readahead->schedule(m_position, available_end());
+    }
+
+    m_file->set_read_position(m_id, m_position);
+
     if (ret <= 0) {
         OATPP_LOGI("Reader::read", "Empty. Position=%s, n=%d, bs=%d", std::to_string(m_position).c_str(), ret, bufferSize);
     } else if (ret < bufferSize) {
@@ -152,6 +221,66 @@ void Reader::wait_for_piece(int piece) {
     OATPP_LOGI("Reader::wait_for_piece", "Done waiting for piece '%d' in %d ms", piece, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - now).count());
 };
 
+bool Reader::open_file() {
+    if (m_fd >= 0)
+        return true;
+
+    // File appears on disk only with the first written piece, so opening is retried on next reads.
+    m_fd = ::open(m_file->full_path().c_str(), O_RDONLY | O_BINARY);
+    if (m_fd < 0)
+        return false;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    m_advised = m_position;
+    advise_file();
+
+    if (lh::config().read_threads > 0)
+        m_readahead = std::make_shared<ReadAhead>(m_fd, 4, 512 * 1024);
+
+    return true;
+}
+
+int Reader::read_file(char *buffer, int size) {
+    // Prefetched data is taken first, the rest is read in place.
+    int n = m_readahead != nullptr ? m_readahead->take(m_position, buffer, size) : 0;
+    if (n >= size)
+        return n;
+
+    auto r = read_at(m_fd, buffer + n, std::size_t(size - n), m_position + n);
+    if (r < 0) {
+        OATPP_LOGI("Reader::read_file", "Error reading file: %s", strerror(errno));
+        return n > 0 ? n : -1;
+    }
+
+    return n + int(r);
+}
+
+std::int64_t Reader::available_end() const {
+    // Prefetch is limited to downloaded pieces within the prioritized window.
+    int end = std::min(piece_from_offset(m_position) + lh::file_readahead_pieces, int(m_file->piece_end()));
+    // Cached bitfield avoids libtorrent round trips on every read chunk.
+    auto pieces = m_torrent->verified_pieces();
+    int p = piece_from_offset(m_position);
+    while (p <= end && p < pieces->size() && pieces->get_bit(lt::piece_index_t(p)))
+        p++;
+
+    return std::min(m_file->size(), p > int(m_file->piece_end()) ? m_file->size() : piece_offset(p));
+}
+
+void Reader::advise_file() {
+#ifdef POSIX_FADV_WILLNEED
+    // Following the reader, ask kernel to prefetch the same window, that is prioritized for download.
+    std::int64_t window = std::int64_t(lh::file_readahead_pieces) * m_piece_size;
+    if (m_position + window / 2 < m_advised)
+        return;
+
+    posix_fadvise(m_fd, off_t(m_position), off_t(window), POSIX_FADV_WILLNEED);
+    m_advised = m_position + window;
+#endif
+}
+
 void Reader::set_piece_priority(int piece, int deadline, lt::download_priority_t priority) {
     if (m_torrent->piece_priority(piece) < priority) {
         m_torrent->piece_priority(piece, priority);
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <mutex>
 
 #include <libtorrent/download_priority.hpp>
@@ -11,6 +13,7 @@
 #include <oatpp/core/base/Environment.hpp>
 
 #include <app/config.h>
+#include <bittorrent/read_ahead.h>
 
 namespace lh {
 
@@ -33,22 +36,35 @@ class Reader : public oatpp::data::stream::ReadCallback {
     int m_piece_start = 0;
     int m_piece_end = 0;
 
-    bool m_isClosing = false;
+    std::atomic<bool> m_isClosing{false};
     bool m_isPrioritized = false;
     bool m_isIterated = false;
 
+    int m_fd = -1;
+    std::int64_t m_advised = 0;
+    std::shared_ptr<ReadAhead> m_readahead;
+
     std::chrono::seconds m_piece_timeout{60};
+    std::chrono::seconds m_idle_timeout{30};
+    // Ticks of system clock, read by the prioritizer and stream limiter without taking the read lock.
+    std::atomic<std::int64_t> m_accessed{0};
 
   public:
     Reader(std::shared_ptr<Torrent> torrent, std::shared_ptr<File> file, oatpp::web::protocol::http::Range range);
     ~Reader() override;
 
     std::int64_t id() const;
+    std::shared_ptr<File> file() const;
+    std::int64_t position() const;
     int piece_start() const;
     int piece_end() const;
     int piece_end_limit() const;
+    int piece_retention_start() const;
 
     bool is_closing() const;
+    bool is_idle() const;
+    std::chrono::time_point<std::chrono::system_clock> accessed() const;
+    void close();
 
     bool is_iterated() const;
     void set_iterated(bool val);
@@ -61,6 +77,11 @@ class Reader : public oatpp::data::stream::ReadCallback {
     void wait_for_piece(int piece);
     void set_piece_priority(int piece, int deadline, lt::download_priority_t priority);
     void set_pieces_priorities(int piece, int pieces);
+
+    bool open_file();
+    void advise_file();
+    int read_file(char *buffer, int size);
+    std::int64_t available_end() const;
 };
 
 } // namespace lh
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "resume_writer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+#include <boost/filesystem.hpp>
+
+#include <libtorrent/write_resume_data.hpp>
+
+#include <oatpp/core/base/Environment.hpp>
+
+namespace lh {
+
+resume_writer::resume_writer() : is_stopped(false) { m_thread = std::thread([this] { run(); }); }
+
+resume_writer::~resume_writer() { stop(); }
+
+void resume_writer::push(const std::string &hash, resume_job job) {
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        jobs[hash] = std::move(job);
+    }
+    m_cv.notify_one();
+}
+
+void resume_writer::set_journal(std::shared_ptr<session_journal> j) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    journal = std::move(j);
+}
+
+void resume_writer::stop() {
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (is_stopped)
+            return;
+        is_stopped = true;
+    }
+    m_cv.notify_one();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void resume_writer::run() {
+    for (;;) {
+        std::map<std::string, resume_job> batch;
+        std::shared_ptr<session_journal> current;
+        bool is_last;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, std::chrono::seconds(1), [this] { return is_stopped || !jobs.empty(); });
+
+            batch.swap(jobs);
+            current = journal;
+            is_last = is_stopped;
+        }
+
+        for (const auto &j : batch)
+            write(j.first, j.second);
+
+        // Metadata, removals and resume data of the whole batch go to the journal with one write.
+        if (current != nullptr)
+            current->flush();
+
+        if (is_last)
+            return;
+    }
+}
+
+void resume_writer::write(const std::string &hash, const resume_job &job) const {
+    auto data = lt::write_resume_data_buf(job.params);
+
+    if (job.journal != nullptr) {
+        job.journal->put_resume(hash, data);
+        return;
+    }
+
+    OATPP_LOGI("resume_writer::write", "Saving resume data to: %s", job.path.c_str());
+
+    // Resume file is replaced atomically, so a crash never leaves it truncated.
+    auto tmp_path = job.path + ".tmp";
+    {
+        std::ofstream of(tmp_path, std::ios_base::binary | std::ios_base::trunc);
+        of.unsetf(std::ios_base::skipws);
+        of.write(data.data(), std::streamsize(data.size()));
+        if (!of) {
+            OATPP_LOGE("resume_writer::write", "Could not write resume data to: %s", tmp_path.c_str());
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+
+    // Boost rename replaces existing file on Windows as well, unlike std::rename.
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmp_path, job.path, ec);
+    if (ec) {
+        OATPP_LOGE("resume_writer::write", "Could not replace resume data at %s: %s", job.path.c_str(), ec.message().c_str());
+        std::remove(tmp_path.c_str());
+    }
+}
+
+} // namespace lh
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <libtorrent/add_torrent_params.hpp>
+
+#include <bittorrent/session_journal.h>
+
+namespace lh {
+
+struct resume_job {
+  public:
+    lt::add_torrent_params params;
+    std::string path;
+    std::shared_ptr<session_journal> journal;
+};
+
+// Background writer of resume data, so alert handling does not wait for encoding and disk.
+//  Jobs are coalesced per torrent, only the latest resume data of a torrent is written.
+//  Session journal is flushed from here as well, every second.
+struct resume_writer {
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+
+    std::map<std::string, resume_job> jobs;
+    std::shared_ptr<session_journal> journal;
+    bool is_stopped;
+
+    void run();
+    void write(const std::string &hash, const resume_job &job) const;
+
+  public:
+    resume_writer();
+    ~resume_writer();
+
+    resume_writer(const resume_writer &) = delete;
+    resume_writer &operator=(const resume_writer &) = delete;
+
+    void push(const std::string &hash, resume_job job);
+
+    void set_journal(std::shared_ptr<session_journal> j);
+
+    void stop();
+};
+
+} // namespace lh
@@ -0,0 +1,108 @@
+#include "ring_storage.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <app/application.h>
+#include <utils/path.h>
+#include <utils/system.h>
+
+namespace lh {
+
+ring_storage::ring_storage(lt::storage_params const &params, std::int64_t size) : memory_storage(params, size), fd(-1) {
+    auto &config = lh::config();
+    path = path_append(config.ring_path.empty() ? config.download_path : config.ring_path,
+                       "ring_" + get_random_numeric(10) + ".ring");
+}
+
+ring_storage::~ring_storage() {
+    if (fd >= 0)
+        ::close(fd);
+#ifdef _WIN32
+    ::unlink(path.c_str());
+#endif
+}
+
+int ring_storage::open_ring() {
+    int ring_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0600);
+    if (ring_fd < 0)
+        return ring_fd;
+
+#ifndef _WIN32
+    // File is not needed after the descriptor is closed, so unlinking it right away
+    //  makes sure that nothing is left on disk after a crash.
+    ::unlink(path.c_str());
+#endif
+    return ring_fd;
+}
+
+void ring_storage::initialize(lt::storage_error &ec) {
+    fd = open_ring();
+    if (fd < 0) {
+        OATPP_LOGE("ring_storage::initialize", "Could not open ring file '%s': %s", path.c_str(), strerror(errno));
+        ec.ec = lt::error_code(errno, lt::system_category());
+        ec.operation = lt::operation_t::file_open;
+        return;
+    }
+
+    OATPP_LOGI("ring_storage::initialize", "Using ring file '%s' for %d buffer items (%s)", path.c_str(), buffer_size,
+                humanize_bytes(buffer_size * piece_length).c_str());
+
+    memory_storage::initialize(ec);
+}
+
+lt::error_code ring_storage::create_buffers(int start, int end) {
+    if (fd < 0)
+        return lt::error_code(EBADF, lt::system_category());
+
+    // Ring file is preallocated to avoid fragmentation and running out of space while streaming.
+    off_t size = off_t(end) * piece_length;
+#if defined(__linux__)
+    int err = posix_fallocate(fd, 0, size);
+#else
+    int err = ftruncate(fd, size) == 0 ? 0 : errno;
+#endif
+    if (err != 0) {
+        OATPP_LOGE("ring_storage::create_buffers", "Could not allocate %s for ring file: %s", humanize_bytes(size).c_str(),
+                   strerror(err));
+        return lt::error_code(err, lt::system_category());
+    }
+
+    // Buffers are added only when the file can hold them.
+    for (int i = start; i < end; i++) {
+        buffers.emplace_back(i, piece_length, false);
+    }
+    return lt::error_code();
+}
+
+lt::error_code ring_storage::read_buffer(int bi, char *data, int offset, int length) {
+    auto n = read_at(fd, data, std::size_t(length), std::int64_t(bi) * piece_length + offset);
+    if (n == length)
+        return lt::error_code();
+
+    // Short read means the ring file lost data, it must not be served as a piece.
+    int err = n < 0 ? errno : EIO;
+    OATPP_LOGE("ring_storage::read_buffer", "Could not read buffer %d: %s", bi, strerror(err));
+    return lt::error_code(err, lt::system_category());
+}
+
+lt::error_code ring_storage::write_buffer(int bi, const char *data, int offset, int length) {
+    auto n = write_at(fd, data, std::size_t(length), std::int64_t(bi) * piece_length + offset);
+    if (n == length)
+        return lt::error_code();
+
+    int err = n < 0 ? errno : ENOSPC;
+    OATPP_LOGE("ring_storage::write_buffer", "Could not write buffer %d: %s", bi, strerror(err));
+    return lt::error_code(err, lt::system_category());
+}
+
+bool ring_storage::is_spillable() const { return false; }
+
+lt::storage_interface *ring_storage_constructor(lt::storage_params const &params, lt::file_pool & /*unused*/) {
+    return new ring_storage(params, std::int64_t(lh::config().ring_size) * 1024 * 1024);
+}
+
+} // namespace lh
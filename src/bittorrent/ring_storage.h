@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <libtorrent/storage.hpp>
+#include <libtorrent/storage_defs.hpp>
+
+#include <bittorrent/memory_storage.h>
+
+namespace lh {
+
+// Storage with the same slots and eviction as memory_storage, but slots are kept
+//  in a preallocated ring file instead of RAM.
+struct ring_storage : memory_storage {
+  protected:
+    std::string path;
+    int fd;
+
+    virtual int open_ring();
+
+    lt::error_code create_buffers(int start, int end) override;
+
+    lt::error_code read_buffer(int bi, char *data, int offset, int length) override;
+
+    lt::error_code write_buffer(int bi, const char *data, int offset, int length) override;
+
+    bool is_spillable() const override;
+
+  public:
+    ring_storage(lt::storage_params const &params, std::int64_t size);
+    ~ring_storage() override;
+
+    void initialize(lt::storage_error &ec) override;
+};
+
+lt::storage_interface *ring_storage_constructor(lt::storage_params const &params, lt::file_pool &);
+
+} // namespace lh
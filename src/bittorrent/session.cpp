@@ -1,8 +1,16 @@
 #include "session.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <future>
+#include <iterator>
 #include <mutex>
+#include <sstream>
 #include <stdexcept>
 #include <thread>
 
@@ -11,6 +19,9 @@
 
 #include <libtorrent/alert_types.hpp>
 #include <libtorrent/bdecode.hpp>
+#include <libtorrent/bencode.hpp>
+#include <libtorrent/entry.hpp>
+#include <libtorrent/hasher.hpp>
 #include <libtorrent/ip_filter.hpp>
 #include <libtorrent/magnet_uri.hpp>
 #include <libtorrent/read_resume_data.hpp>
@@ -36,8 +47,36 @@ using clk = std::chrono::steady_clock;
 
 namespace lh {
 
-// Lock for operations with m_torrents
+// Serializes updates of m_torrents snapshot, readers do not lock
 std::mutex torrentsMutex;
+std::mutex streamsMutex;
+
+// Torrents, submitted with async_add_torrent and waiting for add_torrent_alert
+struct pending_torrent {
+    bool is_paused;
+    lh::storage_type_t storage;
+    std::chrono::time_point<std::chrono::system_clock> added_time;
+};
+std::mutex pendingMutex;
+std::map<lt::sha1_hash, pending_torrent> pendingTorrents;
+std::atomic<int> loadTotal{0};
+std::atomic<int> loadDone{0};
+
+// Pending torrent is taken once, either by its add alert or by reconciliation.
+static bool take_pending_torrent(const lt::sha1_hash &ih, pending_torrent &pending) {
+    {
+        std::lock_guard<std::mutex> guard(pendingMutex);
+        auto match = pendingTorrents.find(ih);
+        if (match == pendingTorrents.end())
+            return false;
+
+        pending = match->second;
+        pendingTorrents.erase(match);
+    }
+
+    loadDone++;
+    return true;
+}
 
 const std::string extraTrackersURLTemplate = "https://ngosang.github.io/trackerslist/trackers_%s.txt";
 const std::vector<std::string> defaultTrackers = {
@@ -76,16 +115,81 @@ const std::vector<std::string> defaultTrackers = {
     "udp://torrent.by:2710",
     "udp://tracker.cortexlabs.ai:5008"
 };
-std::vector<std::string> extraTrackers;
+
+// Extra trackers for new torrents, replaced as a whole when the list is refreshed
+std::mutex trackersMutex;
+std::shared_ptr<const std::vector<std::string>> extraTrackers = std::make_shared<const std::vector<std::string>>();
+
+std::shared_ptr<const std::vector<std::string>> get_extra_trackers() {
+    std::lock_guard<std::mutex> guard(trackersMutex);
+    return extraTrackers;
+}
+
+void set_extra_trackers(bool is_minimum, const std::string &body) {
+    auto trackers = std::make_shared<std::vector<std::string>>(defaultTrackers);
+
+    std::stringstream ss(body);
+    std::string line;
+    while (!is_minimum && std::getline(ss, line, '\n')) {
+        boost::trim(line);
+
+        if (line.empty() || std::find(trackers->begin(), trackers->end(), line) != trackers->end())
+            continue;
+
+        trackers->emplace_back(line);
+    }
+
+    OATPP_LOGD("Session::load_trackers", "Using %d extra trackers", trackers->size());
+
+    std::lock_guard<std::mutex> guard(trackersMutex);
+    extraTrackers = trackers;
+}
+
+// Downloads trackers list in background and keeps it in cache file for next starts.
+void fetch_trackers(const std::string &uri, const std::string &cache_path) {
+    OATPP_LOGD("Session::load_trackers", "Downloading trackers from url: %s", uri.c_str());
+
+    auto res = do_request(uri);
+    if (!res) {
+        OATPP_LOGE("Session::load_trackers", "Could not download file from url '%s'. Response is null", uri.c_str());
+        return;
+    }
+    if (res->status != 200) {
+        OATPP_LOGE("Session::load_trackers", "Could not download file from url '%s'. Status: %d", uri.c_str(), res->status);
+        return;
+    }
+
+    set_extra_trackers(false, res->body);
+
+    if (cache_path.empty())
+        return;
+
+    auto tmp_path = cache_path + ".tmp";
+    if (!save_file(tmp_path, res->body.data(), res->body.size())) {
+        OATPP_LOGE("Session::load_trackers", "Could not save trackers cache to %s", cache_path.c_str());
+        std::remove(tmp_path.c_str());
+        return;
+    }
+
+    // Boost rename replaces existing file on Windows as well, unlike std::rename.
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmp_path, cache_path, ec);
+    if (ec) {
+        OATPP_LOGE("Session::load_trackers", "Could not replace trackers cache at %s: %s", cache_path.c_str(), ec.message().c_str());
+        std::remove(tmp_path.c_str());
+    }
+}
 
 Session::Session(lh::Config &config) : m_config(config) {
     OATPP_LOGI("Session", "Starting libtorrent session");
 
+    register_alert_handlers();
+
     // Configure lt::settings_pack
     configure();
 
-    // Start lt::session
-    lt::session_params params{m_pack};
+    // Start lt::session, warm with DHT state of the previous run if saved
+    lt::session_params params = load_session_params();
     m_nativeSession = std::make_shared<lt::session>(params, lt::session::add_default_plugins);
 
     // Start lt:: services
@@ -100,6 +204,12 @@ Session::~Session() = default;
 
 std::shared_ptr<Config> Session::config() { return std::shared_ptr<Config>(&m_config); }
 
+std::shared_ptr<piece_cache> Session::cache() const { return std::atomic_load(&m_piece_cache); }
+
+std::shared_ptr<session_journal> Session::journal() const { return std::atomic_load(&m_journal); }
+
+std::shared_ptr<resume_writer> Session::writer() const { return m_writer; }
+
 void Session::run() {
     // Load additional trackers if needed.
     load_trackers();
@@ -130,6 +240,23 @@ void Session::check_directories() {
         , m_config.download_path.c_str(), ec.message().c_str());
         throw lh::Exception(ec.message());
     }
+
+    // Spill folder is optional, so failing to create it only disables spilling.
+    if (m_config.spill_size > 0 && !m_config.spill_path.empty()) {
+        ec = mkpath(m_config.spill_path);
+        if (ec) {
+            OATPP_LOGI("Session::configure", "Failed to create spill directory at %s: %s\n"
+            , m_config.spill_path.c_str(), ec.message().c_str());
+        }
+    }
+
+    if (!m_config.ring_path.empty()) {
+        ec = mkpath(m_config.ring_path);
+        if (ec) {
+            OATPP_LOGI("Session::configure", "Failed to create ring directory at %s: %s\n"
+            , m_config.ring_path.c_str(), ec.message().c_str());
+        }
+    }
 }
 
 void Session::configure() {
@@ -138,6 +265,32 @@ void Session::configure() {
 
     check_directories();
 
+    if (m_config.cache_size > 0 && cache() == nullptr) {
+        auto cache_path = m_config.cache_path.empty() ? path_append(m_config.torrents_path, "cache") : m_config.cache_path;
+        std::atomic_store(&m_piece_cache,
+                          std::make_shared<piece_cache>(cache_path, std::int64_t(m_config.cache_size) * 1024 * 1024));
+    } else if (m_config.cache_size <= 0) {
+        std::atomic_store(&m_piece_cache, std::shared_ptr<piece_cache>());
+    }
+
+    if (m_config.metadata_cache_size > 0 && !m_config.torrents_path.empty() && std::atomic_load(&m_metadata_cache) == nullptr) {
+        std::atomic_store(&m_metadata_cache, std::make_shared<metadata_cache>(path_append(m_config.torrents_path, "metadata"),
+                                                                              m_config.metadata_cache_size));
+    } else if (m_config.metadata_cache_size <= 0) {
+        std::atomic_store(&m_metadata_cache, std::shared_ptr<metadata_cache>());
+    }
+
+    if (m_config.use_session_journal && journal() == nullptr) {
+        std::atomic_store(&m_journal,
+                          std::make_shared<session_journal>(path_append(m_config.torrents_path, "session.journal")));
+    } else if (!m_config.use_session_journal) {
+        std::atomic_store(&m_journal, std::shared_ptr<session_journal>());
+    }
+
+    if (m_writer == nullptr)
+        m_writer = std::make_shared<resume_writer>();
+    m_writer->set_journal(journal());
+
     m_pack.set_str(lt::settings_pack::user_agent, user_agent);
 
     // Bools
@@ -163,7 +316,7 @@ void Session::configure() {
     m_pack.set_bool(lt::settings_pack::enable_dht, false);
 
     m_pack.set_int(lt::settings_pack::listen_queue_size, 30);
-    m_pack.set_int(lt::settings_pack::alert_queue_size, std::numeric_limits<int>::max() / 2);
+    m_pack.set_int(lt::settings_pack::alert_queue_size, std::max(1000, m_config.alert_queue_size));
     m_pack.set_int(lt::settings_pack::aio_threads, std::max(1, int(std::thread::hardware_concurrency())) * 4);
     m_pack.set_int(lt::settings_pack::cache_size, -1);
     m_pack.set_int(lt::settings_pack::mixed_mode_algorithm, lt::settings_pack::prefer_tcp);
@@ -308,6 +461,12 @@ void Session::configure() {
                                                       lt::alert::performance_warning | lt::alert::status_notification |
                                                       lt::alert::tracker_notification | lt::alert_category::status);
 
+    // Finished pieces are needed to fill persistent piece cache.
+    if (m_config.cache_size > 0) {
+        m_pack.set_int(lt::settings_pack::alert_mask,
+                       m_pack.get_int(lt::settings_pack::alert_mask) | lt::alert::piece_progress_notification);
+    }
+
     if (m_config.use_libtorrent_logging) {
         m_pack.set_int(lt::settings_pack::alert_mask, lt::alert::all_categories);
     }
@@ -475,50 +634,60 @@ void Session::stop_services() {
     m_nativeSession->apply_settings(m_pack);
 }
 
+void Session::register_alert_handlers() {
+    m_alert_handlers.assign(lt::num_alert_types, nullptr);
+
+    auto ignore = [](Session &, const lt::alert *) {};
+    auto dispatch = [](Session &s, const lt::alert *a) { s.dispatch_alert(a); };
+
+    m_alert_handlers[lt::session_stats_header_alert::alert_type] = ignore;
+    m_alert_handlers[lt::file_completed_alert::alert_type] = ignore;
+
+    // Handle alert to specific torrent
+    m_alert_handlers[lt::save_resume_data_alert::alert_type] = dispatch;
+    m_alert_handlers[lt::dht_reply_alert::alert_type] = dispatch;
+    m_alert_handlers[lt::tracker_announce_alert::alert_type] = dispatch;
+    m_alert_handlers[lt::tracker_error_alert::alert_type] = dispatch;
+    m_alert_handlers[lt::tracker_reply_alert::alert_type] = dispatch;
+    m_alert_handlers[lt::tracker_warning_alert::alert_type] = dispatch;
+    m_alert_handlers[lt::piece_finished_alert::alert_type] = dispatch;
+
+    register_alert_handler(&Session::handle_state_update_alert);
+    register_alert_handler(&Session::handle_session_stats_alert);
+    register_alert_handler(&Session::handle_metadata_received_alert);
+    register_alert_handler(&Session::handle_alerts_dropped_alert);
+    register_alert_handler(&Session::handle_add_torrent_alert);
+}
+
 void Session::consume_alerts() {
     OATPP_LOGI("Session::consume_alerts", "Starting alerts consumer thread");
 
     clk::time_point last_save_resume = clk::now();
-    std::chrono::seconds save_resume_period{30};
+    std::chrono::seconds save_resume_period{std::max(m_config.session_save, 1)};
+    clk::time_point last_save_state = clk::now();
+    std::chrono::minutes save_state_period{5};
+    clk::time_point last_update = clk::now();
+    std::chrono::milliseconds update_period{500};
 
     for (;;) {
-        std::vector<lt::alert *> alerts;
-        m_nativeSession->pop_alerts(&alerts);
-
-        for (const lt::alert *a : alerts) {
-            if (lh::is_closing) {
-                OATPP_LOGI("Session::consume_alerts", "Stop alert processing due to closing application");
-                return;
-            }
-
-            switch (a->type()) {
-            case lt::session_stats_header_alert::alert_type:
-            case lt::file_completed_alert::alert_type:
-                // Ignore alert
-                break;
-            case lt::save_resume_data_alert::alert_type:
-            case lt::dht_reply_alert::alert_type:
-            case lt::tracker_announce_alert::alert_type:
-            case lt::tracker_error_alert::alert_type:
-            case lt::tracker_reply_alert::alert_type:
-            case lt::tracker_warning_alert::alert_type:
-                // Handle alert to specific torrent
-                dispatch_alert(a);
-                break;
-            case lt::state_update_alert::alert_type:
-                handle_state_update_alert(static_cast<const lt::state_update_alert *>(a));
-                break;
-            case lt::session_stats_alert::alert_type:
-                handle_session_stats_alert(static_cast<const lt::session_stats_alert *>(a));
-                break;
-            case lt::metadata_received_alert::alert_type:
-                handle_metadata_received_alert(static_cast<const lt::metadata_received_alert *>(a));
-                break;
-            default:
-                OATPP_LOGD("Session::consume_alerts", "Alert: %s, Message: %s", a->what(), a->message().c_str());
+        // Alerts are handled as soon as they are posted, timeout only drives periodic updates below.
+        if (m_nativeSession->wait_for_alert(std::chrono::milliseconds(100)) != nullptr) {
+            std::vector<lt::alert *> alerts;
+            m_nativeSession->pop_alerts(&alerts);
+
+            for (const lt::alert *a : alerts) {
+                if (lh::is_closing) {
+                    OATPP_LOGI("Session::consume_alerts", "Stop alert processing due to closing application");
+                    return;
+                }
+
+                int type = a->type();
+                if (type >= 0 && type < int(m_alert_handlers.size()) && m_alert_handlers[type])
+                    m_alert_handlers[type](*this, a);
+                else
+                    OATPP_LOGD("Session::consume_alerts", "Alert: %s, Message: %s", a->what(), a->message().c_str());
             }
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
 
         if (lh::is_closing) {
             OATPP_LOGI("Session::consume_alerts", "Stop alert processing due to closing application");
@@ -530,6 +699,15 @@ void Session::consume_alerts() {
             trigger_resume_data();
         }
 
+        if (clk::now() - last_save_state > save_state_period) {
+            last_save_state = clk::now();
+            save_session_state();
+        }
+
+        if (clk::now() - last_update < update_period)
+            continue;
+        last_update = clk::now();
+
         if (m_refresh_requested)
             m_refresh_requested = false;
         else
@@ -541,7 +719,7 @@ void Session::prioritize() {
     OATPP_LOGI("Session::prioritize", "Starting prioritizer thread");
 
     for (;;) {
-        for (const auto &t : m_torrents) {
+        for (const auto &t : *torrents()) {
             if (t->is_buffering()) {
                 // Calculate buffer progress
                 t->update_buffer_progress();
@@ -576,119 +754,303 @@ void Session::close() {
 
     m_isClosing = true;
 
+    // DHT state is saved before DHT is stopped, otherwise routing table is already empty.
+    save_session_state();
+
     // Stop lt:: services
     stop_services();
 
-    std::lock_guard<std::mutex> guard(torrentsMutex);
-    for (const auto &t : m_torrents)
+    for (const auto &t : *torrents())
         t->files().clear();
+
+    // Queued resume data is written before the final journal flush.
+    if (m_writer != nullptr)
+        m_writer->stop();
+
+    auto journal = this->journal();
+    if (journal != nullptr)
+        journal->flush();
 }
 
-void Session::load_previous_torrents() {
-    if (!m_config.autoload_torrents || m_config.torrents_path.empty())
+std::string Session::state_path() const {
+    if (m_config.torrents_path.empty())
+        return "";
+    return path_append(m_config.torrents_path, "session.state");
+}
+
+lt::session_params Session::load_session_params() {
+    lt::session_params params{m_pack};
+
+    std::vector<char> data;
+    auto path = state_path();
+    if (m_config.disable_dht || path.empty() || !load_file(path, data))
+        return params;
+
+    lt::error_code ec;
+    auto node = lt::bdecode(data, ec);
+    if (ec) {
+        OATPP_LOGE("Session::load_session_params", "Could not decode session state %s: %s", path.c_str(),
+                   ec.message().c_str());
+        return params;
+    }
+
+    // Only DHT state is restored, settings always come from the config.
+    params = lt::read_session_params(node, lt::session_handle::save_dht_state);
+    params.settings = m_pack;
+
+    OATPP_LOGI("Session::load_session_params", "Restored DHT state with %d nodes from %s",
+               int(params.dht_state.nodes.size() + params.dht_state.nodes6.size()), path.c_str());
+    return params;
+}
+
+void Session::save_session_state() {
+    auto path = state_path();
+    if (m_config.disable_dht || path.empty() || m_nativeSession == nullptr)
         return;
 
-    torrentsMutex.lock();
-    m_torrents.clear();
-    torrentsMutex.unlock();
+    lt::entry e;
+    m_nativeSession->save_state(e, lt::session_handle::save_dht_state);
 
-    OATPP_LOGI("Session::load_previous_torrents", "Loading previous torrents from: %s", m_config.torrents_path.c_str());
+    std::vector<char> data;
+    lt::bencode(std::back_inserter(data), e);
+
+    auto tmp_path = path + ".tmp";
+    if (!save_file(tmp_path, data)) {
+        OATPP_LOGE("Session::save_session_state", "Could not save session state to %s", path.c_str());
+        std::remove(tmp_path.c_str());
+        return;
+    }
+
+    // Boost rename replaces existing file on Windows as well, unlike std::rename.
     boost::system::error_code ec;
-    std::multimap<std::time_t, boost::filesystem::path> entries = list_dir(
-        m_config.torrents_path, [](lt::string_view p) { return p.size() > 8 && p.substr(p.size() - 8) == ".torrent"; }, ec);
+    boost::filesystem::rename(tmp_path, path, ec);
     if (ec) {
-        OATPP_LOGE("Session::load_previous_torrents", "Failed to list directory '%s': %s", m_config.torrents_path.c_str(),
-                   ec.message().c_str());
+        OATPP_LOGE("Session::save_session_state", "Could not replace session state at %s: %s", path.c_str(), ec.message().c_str());
+        std::remove(tmp_path.c_str());
+    }
+}
+
+void Session::load_previous_torrents() {
+    if (!m_config.autoload_torrents || m_config.torrents_path.empty())
         return;
+
+    update_torrents([](torrents_snapshot &snapshot) {
+        snapshot.list.clear();
+        snapshot.index.clear();
+    });
+
+    // Saved torrent is either metadata from the journal, or a torrent file from the directory.
+    struct saved_torrent {
+        std::string path;
+        std::shared_ptr<const std::vector<char>> data;
+        std::time_t added;
+    };
+    std::vector<saved_torrent> saved;
+
+    auto journal = this->journal();
+    if (journal != nullptr && !journal->is_empty()) {
+        OATPP_LOGI("Session::load_previous_torrents", "Loading previous torrents from session journal");
+        for (const auto &e : journal->get_entries()) {
+            saved.push_back(saved_torrent{e.first, e.second.torrent, std::time_t(e.second.added)});
+        }
+    } else {
+        // Without a journal torrent files are loaded, when journal is enabled they are moved into it on metadata.
+        OATPP_LOGI("Session::load_previous_torrents", "Loading previous torrents from: %s", m_config.torrents_path.c_str());
+        boost::system::error_code ec;
+        std::multimap<std::time_t, boost::filesystem::path> entries = list_dir(
+            m_config.torrents_path, [](lt::string_view p) { return p.size() > 8 && p.substr(p.size() - 8) == ".torrent"; }, ec);
+        if (ec) {
+            OATPP_LOGE("Session::load_previous_torrents", "Failed to list directory '%s': %s", m_config.torrents_path.c_str(),
+                       ec.message().c_str());
+            return;
+        }
+
+        for (auto &p : entries) {
+            auto path = p.second.string();
+            saved.push_back(saved_torrent{path, nullptr, modtime_file(path)});
+        }
     }
 
-    for (auto &p : entries) {
-        std::string path = p.second.string();
-        try {
-            add_torrent(
-                path, 
-                m_config.autoload_torrents_paused, 
-                lh::storage_type_t::file, 
-                false, 
-                std::chrono::system_clock::from_time_t(modtime_file(path))
-            );
-        } catch (std::exception &e) {
-            OATPP_LOGE("Session::load_previous_torrents", "Failed to load torrent '%s': %s", path.c_str(), e.what());
+    loadTotal = int(saved.size());
+    loadDone = 0;
+
+    // Torrent files and resume data are parsed in parallel, while adding to libtorrent is asynchronous,
+    //  torrents are registered in handle_add_torrent_alert, so web server is usable right away.
+    std::atomic<std::size_t> next{0};
+    auto worker = [this, &saved, &next]() {
+        for (std::size_t i = next++; i < saved.size(); i = next++) {
+            auto path = saved[i].path;
+            try {
+                auto st = lh::storage_type_t::file;
+                auto added_time = std::chrono::system_clock::from_time_t(saved[i].added);
+                auto p = saved[i].data != nullptr ? prepare_torrent(*saved[i].data, st, false) : prepare_torrent(path, st, false);
+                auto ih = p.ti ? p.ti->info_hash() : p.info_hash;
+
+                {
+                    std::lock_guard<std::mutex> guard(pendingMutex);
+                    pendingTorrents[ih] = pending_torrent{m_config.autoload_torrents_paused, st, added_time};
+                }
+
+                m_nativeSession->async_add_torrent(std::move(p));
+            } catch (std::exception &e) {
+                OATPP_LOGE("Session::load_previous_torrents", "Failed to load torrent '%s': %s", path.c_str(), e.what());
+                loadDone++;
+            }
         }
+    };
+
+    int threads = std::max(1, std::min(int(std::thread::hardware_concurrency()), int(saved.size())));
+    std::vector<std::future<void>> workers;
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back(std::async(std::launch::async, worker));
     }
+    for (auto &w : workers) {
+        w.wait();
+    }
+
+    OATPP_LOGI("Session::load_previous_torrents", "Submitted %d torrents with %d threads", loadTotal.load(), threads);
+
+    // Add alerts can be dropped on a full alert queue, so loading is finished against the session itself.
+    call_async([this] { reconcile_pending_torrents(); });
 }
 
-void Session::load_trackers() {
-    if (m_config.add_extra_trackers == lh::extra_trackers_t::none) {
+void Session::reconcile_pending_torrents() {
+    const auto stall_timeout = std::chrono::seconds(30);
+    auto progressed = std::chrono::system_clock::now();
+    std::size_t left = 0;
+
+    while (!lh::is_closing) {
+        {
+            std::lock_guard<std::mutex> guard(pendingMutex);
+            if (pendingTorrents.empty())
+                return;
+
+            if (pendingTorrents.size() != left) {
+                left = pendingTorrents.size();
+                progressed = std::chrono::system_clock::now();
+            }
+        }
+
+        // Torrent, present in the session, was added, even if its alert is lost.
+        for (const auto &th : m_nativeSession->get_torrents()) {
+            pending_torrent pending;
+            if (!take_pending_torrent(th.info_hash(), pending))
+                continue;
+
+            OATPP_LOGI("Session::reconcile_pending_torrents", "Registering torrent without add alert: %s", to_hex(th.info_hash()).c_str());
+            try {
+                register_torrent(th, pending.is_paused, pending.storage, pending.added_time);
+            } catch (std::exception &e) {
+                OATPP_LOGE("Session::reconcile_pending_torrents", "Failed to register torrent '%s': %s",
+                           to_hex(th.info_hash()).c_str(), e.what());
+            }
+        }
+
+        // Nothing added for a while means, the rest failed and their error alerts are lost.
+        if (std::chrono::system_clock::now() - progressed > stall_timeout) {
+            std::lock_guard<std::mutex> guard(pendingMutex);
+            OATPP_LOGE("Session::reconcile_pending_torrents", "Giving up on %d torrents, which were not added",
+                       int(pendingTorrents.size()));
+            loadDone += int(pendingTorrents.size());
+            pendingTorrents.clear();
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+void Session::handle_add_torrent_alert(const lt::add_torrent_alert *p) {
+    auto ih = p->params.ti ? p->params.ti->info_hash() : p->params.info_hash;
+
+    // Torrents, added with blocking add_torrent, are registered by the caller.
+    pending_torrent pending;
+    if (!take_pending_torrent(ih, pending))
+        return;
+
+    if (p->error) {
+        OATPP_LOGE("Session::handle_add_torrent_alert", "Failed to add torrent '%s': %s", to_hex(ih).c_str(),
+                   p->error.message().c_str());
         return;
     }
 
-    OATPP_LOGD("Session::load_trackers", "Loading trackers with selection: %s", lh::extra_trackers_to_string(m_config.add_extra_trackers))
-    extraTrackers.clear();
-    for (const auto &t : defaultTrackers) {
-        extraTrackers.emplace_back(t);
+    try {
+        register_torrent(p->handle, pending.is_paused, pending.storage, pending.added_time);
+    } catch (std::exception &e) {
+        OATPP_LOGE("Session::handle_add_torrent_alert", "Failed to register torrent '%s': %s", to_hex(ih).c_str(), e.what());
     }
+}
 
-    if (m_config.add_extra_trackers == lh::extra_trackers_t::minimum) {
+bool Session::is_loading() const { return loadDone < loadTotal; }
+
+double Session::load_progress() const {
+    if (loadTotal <= 0)
+        return 100;
+
+    return double(std::min(loadDone.load(), loadTotal.load())) * 100 / loadTotal;
+}
+
+void Session::load_trackers() {
+    if (m_config.add_extra_trackers == lh::extra_trackers_t::none) {
         return;
     }
 
-    auto uri = Fmt(extraTrackersURLTemplate, extra_trackers_to_string(m_config.add_extra_trackers));
-    OATPP_LOGD("Session::load_trackers", "Downloading tracker from url: %s", uri.c_str());
+    auto selection = extra_trackers_to_string(m_config.add_extra_trackers);
+    OATPP_LOGD("Session::load_trackers", "Loading trackers with selection: %s", selection)
 
-    auto res = do_request(uri);
-    if (!res) {
-        OATPP_LOGE("Could not download file from url '%s'. Response is null", uri.c_str());
+    if (m_config.add_extra_trackers == lh::extra_trackers_t::minimum) {
+        set_extra_trackers(true, "");
         return;
-    } 
-    if (res->status != 200) {
-        OATPP_LOGE("Could not download file from url '%s'. Status: %d", uri.c_str(), res->status);
+    }
+
+    // Local source is read directly, so offline setups never touch the network.
+    auto source = m_config.trackers_source.empty() ? extraTrackersURLTemplate : m_config.trackers_source;
+    if (!boost::starts_with(source, "http://") && !boost::starts_with(source, "https://")) {
+        std::string body;
+        if (!load_file(source, body))
+            OATPP_LOGE("Session::load_trackers", "Could not read trackers from file: %s", source.c_str());
+        set_extra_trackers(false, body);
         return;
     }
 
-    std::stringstream ss(res->body);
-    std::string line;
+    // Cached list is used right away, download happens in background only when cache is missing or stale.
+    //  Cache is keyed on the source as well, so changing it does not serve the list of the previous one.
+    std::string cache_path;
+    if (!m_config.torrents_path.empty()) {
+        auto source_hash = to_hex(lt::hasher(source.data(), int(source.size())).final()).substr(0, 8);
+        cache_path = path_append(m_config.torrents_path, Fmt("trackers_%s_%s.txt", selection, source_hash.c_str()));
+    }
 
-    while(std::getline(ss, line,'\n')){
-        boost::trim(line);
+    std::string body;
+    if (!cache_path.empty() && load_file(cache_path, body)) {
+        set_extra_trackers(false, body);
 
-        if (line.empty())
-            continue;
-        
-        extraTrackers.emplace_back(line);
+        boost::system::error_code ec;
+        auto modified = boost::filesystem::last_write_time(cache_path, ec);
+        if (!ec && std::time(nullptr) - modified < std::time_t(m_config.trackers_cache_ttl) * 3600)
+            return;
+    } else {
+        set_extra_trackers(false, "");
     }
 
-    OATPP_LOGD("Session::load_trackers", "Using %d extra trackers", extraTrackers.size());
+    // Source is user input, so it is never used as a format string.
+    auto uri = source;
+    boost::replace_all(uri, "%s", selection);
+    call_async([uri, cache_path] { fetch_trackers(uri, cache_path); });
 }
 
-std::shared_ptr<Torrent> Session::add_torrent(std::string &uri, bool is_paused, lh::storage_type_t st, 
-    bool is_first_time, std::chrono::time_point<std::chrono::system_clock> added_time) {
+lt::add_torrent_params Session::prepare_torrent(std::string &uri, lh::storage_type_t &st, bool is_first_time) {
     // Trim whitespaces
     boost::trim(uri);
     if (uri.empty())
         throw lh::Exception("Empty uri parameter");
 
-    std::string storage_description = storage_to_string(st);
-    if (st == storage_type_t::automatic) {
-        st = m_config.download_storage;
-        storage_description += " (" + std::string(storage_to_string(st)) + ")";
-    }
-
+    std::string storage_description = resolve_storage(st);
     OATPP_LOGI("Session::add_torrent", "Adding torrent with uri: %s, storage: %s", uri.c_str(), storage_description.c_str())
 
     lt::error_code ec;
     lt::add_torrent_params p;
 
-    bool is_memory_storage = st == storage_type_t::memory;
-    bool is_skip_priorities = false;
-    std::string hash;
-
-    // Check if download directory is here
-    if (!is_memory_storage && m_config.download_path.empty()) {
-        OATPP_LOGI("Session::add_torrent", "Skipping adding torrent due to missing download path")
-        throw lh::Exception("Missing download path for using file storage");
-    }
-
     // Check if file actually contains a magnet link
     if (uri.rfind("magnet", 0) != 0) {
         std::string file_body;
@@ -709,7 +1071,14 @@ std::shared_ptr<Torrent> Session::add_torrent(std::string &uri, bool is_paused,
                        ec.message().c_str());
             throw lh::Exception(ec.message());
         }
-        hash = to_hex(p.info_hash);
+
+        // Metadata of a magnet, resolved before, makes it start like a torrent file.
+        std::shared_ptr<lt::torrent_info> ti;
+        auto metadata = std::atomic_load(&m_metadata_cache);
+        if (metadata != nullptr && metadata->get(to_hex(p.info_hash), ti)) {
+            OATPP_LOGI("Session::add_torrent", "Using cached metadata for magnet: %s", to_hex(p.info_hash).c_str());
+            p.ti = ti;
+        }
     } else {
         // Local file
         auto ti = std::make_shared<lt::torrent_info>(uri, ec);
@@ -722,29 +1091,85 @@ std::shared_ptr<Torrent> Session::add_torrent(std::string &uri, bool is_paused,
         }
 
         p.ti = ti;
-        if (p.ti)
-            hash = to_hex(p.ti->info_hash());
     }
 
-    if (hash.empty())
-        hash = to_hex(p.info_hash);
+    prepare_params(p, st, is_first_time);
+    return p;
+}
+
+lt::add_torrent_params Session::prepare_torrent(const std::vector<char> &data, lh::storage_type_t &st, bool is_first_time) {
+    std::string storage_description = resolve_storage(st);
+    OATPP_LOGI("Session::add_torrent", "Adding torrent from %d bytes of metadata, storage: %s", int(data.size()),
+               storage_description.c_str())
+
+    lt::error_code ec;
+    lt::add_torrent_params p;
+
+    auto ti = std::make_shared<lt::torrent_info>(data.data(), int(data.size()), ec);
+    if (ec) {
+        OATPP_LOGI("Session::add_torrent", "Failed to load torrent metadata: %s", ec.message().c_str());
+        throw lh::Exception(ec.message());
+    }
+
+    p.ti = ti;
+    prepare_params(p, st, is_first_time);
+    return p;
+}
+
+std::string Session::resolve_storage(lh::storage_type_t &st) const {
+    std::string storage_description = storage_to_string(st);
+    if (st == storage_type_t::automatic) {
+        st = m_config.download_storage;
+        storage_description += " (" + std::string(storage_to_string(st)) + ")";
+    }
+
+    return storage_description;
+}
+
+bool Session::load_resume_data(const std::string &hash, std::vector<char> &data) {
+    auto journal = this->journal();
+    if (journal != nullptr && journal->get_resume(hash, data))
+        return true;
+
+    // Resume files are still read, when journal has nothing yet, to migrate existing torrents.
+    return load_file(resume_file(m_config.torrents_path, hash), data);
+}
+
+void Session::prepare_params(lt::add_torrent_params &p, lh::storage_type_t st, bool is_first_time) {
+    lt::error_code ec;
+
+    bool is_memory_storage = st == storage_type_t::memory || st == storage_type_t::ring;
+    bool is_skip_priorities = false;
+    std::string hash = to_hex(p.ti ? p.ti->info_hash() : p.info_hash);
 
-    if (is_memory_storage) {
+    // Check if download directory is here
+    if (!is_memory_storage && m_config.download_path.empty()) {
+        OATPP_LOGI("Session::add_torrent", "Skipping adding torrent due to missing download path")
+        throw lh::Exception("Missing download path for using file storage");
+    }
+
+    if (st == storage_type_t::ring) {
+        p.storage = lh::ring_storage_constructor;
+    } else if (is_memory_storage) {
         // Set memory size for memory_storage
         lh::memory_size = memory_size();
+#ifdef _WIN32
         p.storage = lh::memory_storage_constructor;
+#else
+        p.storage = m_config.ipc_socket.empty() ? lh::memory_storage_constructor : lh::shared_storage_constructor;
+#endif
     } else {
-        // Read fastresume files
+        // Read fastresume data
         std::vector<char> resume_data;
-        auto resume_path = resume_file(m_config.torrents_path, hash);
-        if (load_file(resume_path, resume_data)) {
+        if (load_resume_data(hash, resume_data)) {
+            auto ti = p.ti;
             p = lt::read_resume_data(resume_data, ec);
             if (ec) {
                 OATPP_LOGI("Session::add_torrent", "Failed to load resume data: %s", ec.message().c_str());
             } else {
-                OATPP_LOGI("Session::add_torrent", "Using resume data: %s", resume_path.c_str());
-                if (p.ti)
-                    hash = to_hex(p.ti->info_hash());
+                OATPP_LOGI("Session::add_torrent", "Using resume data for: %s", hash.c_str());
+                if (!p.ti)
+                    p.ti = ti;
 
                 is_skip_priorities = true;
             }
@@ -753,8 +1178,6 @@ std::shared_ptr<Torrent> Session::add_torrent(std::string &uri, bool is_paused,
 
     if (ec)
         throw lh::Exception(ec.message());
-    if (has_torrent(hash))
-        throw lh::Exception(Fmt("Torrent with hash '%s' already exists", hash.c_str()));
 
     p.max_connections = get_max_connections();
     p.save_path = m_config.download_path;
@@ -775,7 +1198,8 @@ std::shared_ptr<Torrent> Session::add_torrent(std::string &uri, bool is_paused,
             p.trackers.clear();
         
         // Add trackers to torrent info
-        for (auto &tr : extraTrackers) {
+        auto trackers = get_extra_trackers();
+        for (auto &tr : *trackers) {
             if (std::find_if(p.trackers.begin(), p.trackers.end(),
                     [&tr](const std::string &t) { return t == tr; }) == p.trackers.end())
                 p.trackers.emplace_back(tr);
@@ -789,19 +1213,51 @@ std::shared_ptr<Torrent> Session::add_torrent(std::string &uri, bool is_paused,
         p.flags |= lt::torrent_flags::sequential_download;
     else
         p.flags &= ~lt::torrent_flags::sequential_download;
+}
 
+std::shared_ptr<Torrent> Session::add_torrent(std::string &uri, bool is_paused, lh::storage_type_t st, 
+    bool is_first_time, std::chrono::time_point<std::chrono::system_clock> added_time) {
+    return start_torrent(prepare_torrent(uri, st, is_first_time), is_paused, st, added_time);
+}
+
+std::shared_ptr<Torrent> Session::add_torrent(const std::vector<char> &data, bool is_paused, lh::storage_type_t st,
+                                              bool is_first_time, std::chrono::time_point<std::chrono::system_clock> added_time) {
+    // Uploaded body can be a magnet link as well as torrent metadata.
+    auto start = std::find_if(data.begin(), data.end(), [](char c) { return !std::isspace(static_cast<unsigned char>(c)); });
+    const std::string magnet = "magnet";
+    if (std::size_t(data.end() - start) >= magnet.size() && std::equal(magnet.begin(), magnet.end(), start)) {
+        std::string uri(start, data.end());
+        return add_torrent(uri, is_paused, st, is_first_time, added_time);
+    }
+
+    return start_torrent(prepare_torrent(data, st, is_first_time), is_paused, st, added_time);
+}
+
+std::shared_ptr<Torrent> Session::start_torrent(lt::add_torrent_params p, bool is_paused, lh::storage_type_t st,
+                                                std::chrono::time_point<std::chrono::system_clock> added_time) {
+    auto hash = to_hex(p.ti ? p.ti->info_hash() : p.info_hash);
+    if (has_torrent(hash))
+        throw lh::Exception(Fmt("Torrent with hash '%s' already exists", hash.c_str()));
+
+    lt::error_code ec;
     lt::torrent_handle th = m_nativeSession->add_torrent(std::move(p), ec);
     if (ec)
         throw lh::Exception(ec.message());
 
+    return register_torrent(th, is_paused, st, added_time);
+}
+
+std::shared_ptr<Torrent> Session::register_torrent(const lt::torrent_handle &th, bool is_paused, lh::storage_type_t st,
+                                                   std::chrono::time_point<std::chrono::system_clock> added_time) {
     if (!is_paused)
         th.resume();
 
     auto torrent = std::make_shared<Torrent>(m_nativeSession, th, st, added_time);
 
-    torrentsMutex.lock();
-    m_torrents.emplace_back(torrent);
-    torrentsMutex.unlock();
+    update_torrents([&](torrents_snapshot &snapshot) {
+        snapshot.list.emplace_back(torrent);
+        snapshot.index[th.info_hash()] = torrent;
+    });
 
     if (torrent->has_metadata())
         torrent->on_metadata_received();
@@ -811,25 +1267,46 @@ std::shared_ptr<Torrent> Session::add_torrent(std::string &uri, bool is_paused,
     return torrent;
 }
 
-std::vector<std::shared_ptr<Torrent>> Session::torrents() { return m_torrents; }
+template <class F>
+void Session::update_torrents(F &&fun) {
+    std::lock_guard<std::mutex> guard(torrentsMutex);
+
+    auto snapshot = std::make_shared<torrents_snapshot>(*std::atomic_load(&m_torrents));
+    fun(*snapshot);
+    std::atomic_store(&m_torrents, std::shared_ptr<const torrents_snapshot>(std::move(snapshot)));
+}
+
+torrents_list Session::torrents() const {
+    // Aliasing pointer keeps the whole snapshot alive, while exposing only the list.
+    auto snapshot = std::atomic_load(&m_torrents);
+    return torrents_list(snapshot, &snapshot->list);
+}
+
+std::shared_ptr<Torrent> Session::find_torrent(const lt::sha1_hash &hash) {
+    auto snapshot = std::atomic_load(&m_torrents);
+
+    auto match = snapshot->index.find(hash);
+    if (match == snapshot->index.end())
+        return nullptr;
+
+    return match->second;
+}
 
 std::shared_ptr<Torrent> Session::get_torrent(std::string &hash) {
-    std::lock_guard<std::mutex> guard(torrentsMutex);
+    lt::sha1_hash ih;
+    std::shared_ptr<Torrent> torrent = nullptr;
+    if (from_hex(hash, ih))
+        torrent = find_torrent(ih);
 
-    auto match =
-        std::find_if(m_torrents.begin(), m_torrents.end(), [&hash](const std::shared_ptr<Torrent>& t) { return t->hash() == hash; });
-    if (match == m_torrents.end())
+    if (torrent == nullptr)
         throw lh::TorrentException(Fmt("Torrent with hash '%s' not found", hash.c_str()));
 
-    return *match;
+    return torrent;
 }
 
 bool Session::has_torrent(std::string &hash) {
-    std::lock_guard<std::mutex> guard(torrentsMutex);
-
-    auto match = std::find_if(m_torrents.begin(), m_torrents.end(),
-                              [&hash](const std::shared_ptr<Torrent> &t) { return t->hash() == hash; });
-    return match != m_torrents.end();
+    lt::sha1_hash ih;
+    return from_hex(hash, ih) && find_torrent(ih) != nullptr;
 }
 
 bool Session::remove_torrent(std::string &hash, bool is_delete_files, bool is_delete_data) {
@@ -838,15 +1315,146 @@ bool Session::remove_torrent(std::string &hash, bool is_delete_files, bool is_de
 
     OATPP_LOGI("Session::remove_torrent", "Removed torrent with hash: %s", torrent->hash().c_str());
 
-    std::lock_guard<std::mutex> guard(torrentsMutex);
+    update_torrents([&](torrents_snapshot &snapshot) {
+        snapshot.list.erase(std::remove(snapshot.list.begin(), snapshot.list.end(), torrent), snapshot.list.end());
 
-    auto match = std::find_if(m_torrents.begin(), m_torrents.end(),
-                              [&hash](const std::shared_ptr<Torrent> &t) { return t->hash() == hash; });
-    m_torrents.erase(match);
+        lt::sha1_hash ih;
+        if (from_hex(torrent->hash(), ih))
+            snapshot.index.erase(ih);
+    });
 
     return true;
 }
 
+std::shared_ptr<Torrent> Session::promote_torrent(std::string &hash) {
+    // Streams are not opened until the torrent is added again, so the readers check stays valid.
+    std::lock_guard<std::mutex> guard(streamsMutex);
+
+    auto torrent = get_torrent(hash);
+    if (!torrent->is_memory_storage())
+        throw lh::TorrentException(Fmt("Torrent with hash '%s' is not using memory storage", hash.c_str()));
+    if (!torrent->has_metadata())
+        throw lh::TorrentException(Fmt("Torrent with hash '%s' does not have metadata", hash.c_str()));
+    if (torrent->has_readers())
+        throw lh::TorrentException(Fmt("Torrent with hash '%s' has active readers", hash.c_str()));
+
+    OATPP_LOGI("Session::promote_torrent", "Moving torrent with hash '%s' to file storage", hash.c_str());
+
+    // Libtorrent cannot change storage of an active torrent, so it is added again,
+    //  with pieces from memory written to the new storage.
+    auto pieces = torrent->export_pieces();
+    auto data = torrent->generate();
+    std::vector<int> selected;
+    for (const auto &f : torrent->files()) {
+        if (f->is_selected())
+            selected.push_back(int(f->index()));
+    }
+
+    // Parameters are prepared before removal, so invalid metadata or missing download path keep the torrent as is.
+    auto st = lh::storage_type_t::file;
+    auto params = prepare_torrent(data, st, false);
+
+    auto original_st = torrent->storage_type();
+    auto is_paused = torrent->is_paused();
+    auto added_time = torrent->added_time();
+    remove_torrent(hash, true, false);
+
+    auto restore = [&](const std::shared_ptr<Torrent> &t) {
+        t->import_pieces(pieces);
+        for (const auto &f : t->files()) {
+            if (selected.empty() || std::find(selected.begin(), selected.end(), int(f->index())) != selected.end())
+                f->set_priority(lt::default_priority);
+        }
+    };
+
+    try {
+        auto promoted = start_torrent(std::move(params), is_paused, st, added_time);
+        restore(promoted);
+        return promoted;
+    } catch (std::exception &e) {
+        OATPP_LOGE("Session::promote_torrent", "Could not add torrent '%s' with file storage, restoring it in memory: %s",
+                   hash.c_str(), e.what());
+    }
+
+    // Torrent goes back to the storage it had, with the same pieces, so a failed promotion loses nothing.
+    if (!has_torrent(hash)) {
+        auto restored_params = prepare_torrent(data, original_st, false);
+        restore(start_torrent(std::move(restored_params), is_paused, original_st, added_time));
+    }
+
+    throw lh::TorrentException(Fmt("Could not move torrent with hash '%s' to file storage", hash.c_str()));
+}
+
+bool Session::wait_for_metadata(const std::shared_ptr<Torrent> &torrent) {
+    auto deadline = std::chrono::system_clock::now() + std::chrono::seconds(m_config.magnet_resolve_timeout);
+    while (!torrent->has_metadata()) {
+        if (lh::is_closing || std::chrono::system_clock::now() >= deadline) {
+            OATPP_LOGI("Session::wait_for_metadata", "Metadata for '%s' is not resolved in %d seconds", torrent->hash().c_str(),
+                       m_config.magnet_resolve_timeout);
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    return true;
+}
+
+std::shared_ptr<Reader> Session::open_stream(const std::shared_ptr<Torrent> &torrent, const std::shared_ptr<File> &file,
+                                             const oatpp::web::protocol::http::Range &range) {
+    auto deadline = std::chrono::system_clock::now() + std::chrono::seconds(m_config.stream_queue_timeout);
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> guard(streamsMutex);
+
+            if (is_stream_allowed(torrent, file)) {
+                auto reader = std::make_shared<lh::Reader>(torrent, file, range);
+                file->register_reader(reader->id(), reader.get());
+                torrent->register_reader(reader);
+                return reader;
+            }
+        }
+
+        if (lh::is_closing || std::chrono::system_clock::now() >= deadline)
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    OATPP_LOGI("Session::open_stream", "Rejecting stream for %s, limits reached", file->path().c_str());
+    return nullptr;
+}
+
+bool Session::is_stream_allowed(const std::shared_ptr<Torrent> &torrent, const std::shared_ptr<File> &file) {
+    auto is_over = [](int limit, int value) { return limit > 0 && value >= limit; };
+    auto is_full = [&]() {
+        return is_over(m_config.max_streams, count_streams()) || is_over(m_config.max_torrent_streams, torrent->active_readers()) ||
+               is_over(m_config.max_file_streams, file->active_readers());
+    };
+
+    if (!is_full())
+        return true;
+
+    // Readers, abandoned by a player after a seek, are closed first.
+    //  When file limit is still reached, the least recently read stream of the file gives up its slot,
+    //  since a new request for the same file is a seek of the same viewer.
+    file->close_idle_readers();
+    if (is_over(m_config.max_file_streams, file->active_readers()))
+        file->close_oldest_reader();
+
+    return !is_full();
+}
+
+int Session::count_streams() {
+    int result = 0;
+    for (const auto &t : *torrents()) {
+        result += t->active_readers();
+    }
+
+    return result;
+}
+
 std::string Session::get_user_agent() const {
     switch (m_config.spoof_user_agent) {
     case lh::user_agent_type_t::lt2http:
@@ -888,7 +1496,9 @@ int Session::get_max_connections() {
     return 75;
 }
 
-bool Session::is_memory_storage() const { return m_config.download_storage == storage_type_t::memory; }
+bool Session::is_memory_storage() const {
+    return m_config.download_storage == storage_type_t::memory || m_config.download_storage == storage_type_t::ring;
+}
 
 bool Session::is_closing() const { return m_isClosing; }
 
@@ -897,24 +1507,24 @@ void Session::handle_state_update_alert(const lt::state_update_alert *p) {
         return;
 
     for (const lt::torrent_status &status : p->status) {
-        auto hash = to_hex(status.info_hash);
-
-        if (!has_torrent(hash))
-            continue;
-
-        auto torrent = get_torrent(hash);
-        torrent->update_status(status);
+        auto torrent = find_torrent(status.info_hash);
+        if (torrent != nullptr)
+            torrent->update_status(status);
     }
 }
 
 void Session::handle_metadata_received_alert(const lt::metadata_received_alert *p) {
-    std::string hash = to_hex(p->handle.info_hash());
-    if (!has_torrent(hash))
+    auto torrent = find_torrent(p->handle.info_hash());
+    if (torrent == nullptr)
         return;
 
-    OATPP_LOGI("Session::handle_metadata_received_alert", "Received metadata for '%s'", hash.c_str());
-    auto torrent = get_torrent(hash);
+    OATPP_LOGI("Session::handle_metadata_received_alert", "Received metadata for '%s'", torrent->hash().c_str());
     torrent->update_metadata();
+
+    auto ti = p->handle.torrent_file();
+    auto metadata = std::atomic_load(&m_metadata_cache);
+    if (metadata != nullptr && ti != nullptr)
+        metadata->put(torrent->hash(), *ti);
 }
 
 void Session::handle_session_stats_alert(const lt::session_stats_alert *p) {
@@ -927,13 +1537,20 @@ void Session::handle_session_stats_alert(const lt::session_stats_alert *p) {
     }
 }
 
-void Session::dispatch_alert(const lt::alert *a) {
-    auto hash = to_hex(static_cast<const lt::torrent_alert *>(a)->handle.info_hash());
-    if (!has_torrent(hash))
-        return;
+void Session::handle_alerts_dropped_alert(const lt::alerts_dropped_alert *p) {
+    auto dropped = p->dropped_alerts.count();
+    m_alerts_dropped += std::int64_t(dropped);
 
-    auto torrent = get_torrent(hash);
-    torrent->dispatch_alert(a);
+    OATPP_LOGE("Session::handle_alerts_dropped_alert", "Alert queue overflow, dropped %d alert types (increase alert_queue_size)",
+               int(dropped));
+}
+
+std::int64_t Session::alerts_dropped() const { return m_alerts_dropped; }
+
+void Session::dispatch_alert(const lt::alert *a) {
+    auto torrent = find_torrent(static_cast<const lt::torrent_alert *>(a)->handle.info_hash());
+    if (torrent != nullptr)
+        torrent->dispatch_alert(a);
 }
 
 void Session::remove_temporary_file(std::string &path) {
@@ -949,10 +1566,10 @@ void Session::remove_temporary_file(std::string &path) {
 }
 
 void Session::trigger_resume_data() {
-    std::lock_guard<std::mutex> guard(torrentsMutex);
-
-    for (const auto &torrent : m_torrents) {
-        torrent->save_resume_data();
+    // Only torrents with changes since the last save are asked, idle ones cost nothing.
+    for (const auto &torrent : *torrents()) {
+        if (torrent->need_save_resume())
+            torrent->save_resume_data();
     }
 }
 
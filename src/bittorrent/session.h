@@ -1,6 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
 #include <libtorrent/add_torrent_params.hpp>
+#include <libtorrent/alert_types.hpp>
 #include <libtorrent/fwd.hpp>
 #include <libtorrent/session.hpp>
 #include <libtorrent/session_status.hpp>
@@ -10,10 +16,28 @@
 #include <app/config.h>
 
 #include <bittorrent/memory_storage.h>
+#include <bittorrent/metadata_cache.h>
+#include <bittorrent/piece_cache.h>
+#include <bittorrent/reader.h>
+#include <bittorrent/resume_writer.h>
+#include <bittorrent/session_journal.h>
+#include <bittorrent/ring_storage.h>
+#ifndef _WIN32
+#include <bittorrent/shared_storage.h>
+#endif
 #include <bittorrent/torrent.h>
 
 namespace lh {
 
+// Immutable view of session torrents. Writers publish a modified copy,
+//  readers iterate and look up the current one without locks.
+struct torrents_snapshot {
+    std::vector<std::shared_ptr<Torrent>> list;
+    std::unordered_map<lt::sha1_hash, std::shared_ptr<Torrent>> index;
+};
+
+typedef std::shared_ptr<const std::vector<std::shared_ptr<Torrent>>> torrents_list;
+
 class Session {
   private:
     std::shared_ptr<lt::session> m_nativeSession = nullptr;
@@ -23,7 +47,15 @@ class Session {
     std::map<int, std::vector<lt::port_mapping_t>> m_mapped_ports;
 
     lh::Config m_config;
-    std::vector<std::shared_ptr<Torrent>> m_torrents;
+    std::shared_ptr<const torrents_snapshot> m_torrents = std::make_shared<const torrents_snapshot>();
+    // Caches and journal are replaced by reconfigure(), while other threads use them, so they are published atomically.
+    std::shared_ptr<piece_cache> m_piece_cache = nullptr;
+    std::shared_ptr<metadata_cache> m_metadata_cache = nullptr;
+    std::shared_ptr<session_journal> m_journal = nullptr;
+    std::shared_ptr<resume_writer> m_writer = nullptr;
+
+    std::vector<std::function<void(Session &, const lt::alert *)>> m_alert_handlers;
+    std::atomic<std::int64_t> m_alerts_dropped{0};
 
     bool m_refresh_requested = false;
     bool m_isClosing = false;
@@ -33,35 +65,76 @@ class Session {
     ~Session();
 
     std::shared_ptr<Config> config();
+    std::shared_ptr<piece_cache> cache() const;
+    std::shared_ptr<session_journal> journal() const;
+    std::shared_ptr<resume_writer> writer() const;
     void run();
     void check_directories();
     void configure();
     void reconfigure();
     void start_services();
     void stop_services();
+    void register_alert_handlers();
     void consume_alerts();
     void prioritize();
     void request_update();
     void close();
     void load_previous_torrents();
+    void reconcile_pending_torrents();
     void load_trackers();
-
-    std::vector<std::shared_ptr<Torrent>> torrents();
+    std::string state_path() const;
+    lt::session_params load_session_params();
+    void save_session_state();
+
+    template <class F>
+    void update_torrents(F &&fun);
+
+    torrents_list torrents() const;
+    lt::add_torrent_params prepare_torrent(std::string &uri, lh::storage_type_t &st, bool is_first_time);
+    lt::add_torrent_params prepare_torrent(const std::vector<char> &data, lh::storage_type_t &st, bool is_first_time);
+    void prepare_params(lt::add_torrent_params &p, lh::storage_type_t st, bool is_first_time);
+    std::string resolve_storage(lh::storage_type_t &st) const;
+    bool load_resume_data(const std::string &hash, std::vector<char> &data);
+    std::shared_ptr<Torrent> register_torrent(const lt::torrent_handle &th, bool is_paused, lh::storage_type_t st,
+                                              std::chrono::time_point<std::chrono::system_clock> added_time);
     std::shared_ptr<Torrent> add_torrent(std::string &uri, bool is_paused, lh::storage_type_t st, bool is_first_time, std::chrono::time_point<std::chrono::system_clock> added_time);
+    std::shared_ptr<Torrent> add_torrent(const std::vector<char> &data, bool is_paused, lh::storage_type_t st, bool is_first_time,
+                                         std::chrono::time_point<std::chrono::system_clock> added_time);
+    std::shared_ptr<Torrent> start_torrent(lt::add_torrent_params p, bool is_paused, lh::storage_type_t st,
+                                           std::chrono::time_point<std::chrono::system_clock> added_time);
+    std::shared_ptr<Torrent> find_torrent(const lt::sha1_hash &hash);
     std::shared_ptr<Torrent> get_torrent(std::string &hash);
     bool has_torrent(std::string &hash);
     bool remove_torrent(std::string &hash, bool is_delete_files, bool is_delete_data);
+    std::shared_ptr<Torrent> promote_torrent(std::string &hash);
+    bool wait_for_metadata(const std::shared_ptr<Torrent> &torrent);
+
+    std::shared_ptr<Reader> open_stream(const std::shared_ptr<Torrent> &torrent, const std::shared_ptr<File> &file,
+                                        const oatpp::web::protocol::http::Range &range);
+    bool is_stream_allowed(const std::shared_ptr<Torrent> &torrent, const std::shared_ptr<File> &file);
+    int count_streams();
 
     std::string get_user_agent() const;
     static int get_max_connections();
     bool is_memory_storage() const;
     bool is_closing() const;
+    bool is_loading() const;
+    double load_progress() const;
 
     void handle_state_update_alert(const lt::state_update_alert *p);
     void handle_metadata_received_alert(const lt::metadata_received_alert *p);
     void handle_session_stats_alert(const lt::session_stats_alert *p);
+    void handle_alerts_dropped_alert(const lt::alerts_dropped_alert *p);
+    void handle_add_torrent_alert(const lt::add_torrent_alert *p);
     void dispatch_alert(const lt::alert *a);
 
+    template <class T>
+    void register_alert_handler(void (Session::*handler)(const T *)) {
+        m_alert_handlers[T::alert_type] = [handler](Session &s, const lt::alert *a) { (s.*handler)(static_cast<const T *>(a)); };
+    }
+
+    std::int64_t alerts_dropped() const;
+
     static void remove_temporary_file(std::string &path);
     void trigger_resume_data();
 
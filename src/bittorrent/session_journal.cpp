@@ -0,0 +1,363 @@
+#include "session_journal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef _WIN32
+#include <io.h>
+#endif
+
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+
+#include <oatpp/core/base/Environment.hpp>
+
+#include <utils/numbers.h>
+
+namespace lh {
+
+namespace {
+
+#if defined(_WIN32)
+const int journal_open_flags = O_BINARY;
+#elif defined(O_CLOEXEC)
+const int journal_open_flags = O_CLOEXEC;
+#else
+const int journal_open_flags = 0;
+#endif
+
+// Data of the file reaches the disk, not only the OS cache.
+int sync_file(int fd) {
+#if defined(_WIN32)
+    return _commit(fd);
+#elif defined(__APPLE__)
+    return ::fcntl(fd, F_FULLFSYNC);
+#else
+    return ::fdatasync(fd);
+#endif
+}
+
+int truncate_file(int fd, std::int64_t length) {
+#if defined(_WIN32)
+    return _chsize_s(fd, length);
+#else
+    return ::ftruncate(fd, off_t(length));
+#endif
+}
+
+const std::uint32_t journal_magic = 0x314a544c; // "LTJ1"
+const std::size_t journal_hash_size = 40;
+
+enum journal_record_t { record_torrent = 1, record_resume = 2, record_remove = 3 };
+
+// magic, type, hash, time, length, checksum
+const std::size_t journal_header_size = 4 + 4 + journal_hash_size + 8 + 4 + 4;
+
+std::uint32_t checksum(const char *header, const char *data, std::size_t length) {
+    boost::crc_32_type crc;
+    crc.process_bytes(header, journal_header_size - 4);
+    crc.process_bytes(data, length);
+    return crc.checksum();
+}
+
+bool write_all(int fd, const char *data, std::size_t length) {
+    while (length > 0) {
+        auto n = ::write(fd, data, length);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+
+        data += n;
+        length -= std::size_t(n);
+    }
+
+    return true;
+}
+
+} // namespace
+
+session_journal::session_journal(std::string path) : path(std::move(path)), fd(-1), size(0), live_size(0) {
+    load();
+
+    fd = ::open(this->path.c_str(), O_WRONLY | O_CREAT | O_APPEND | journal_open_flags, 0644);
+    if (fd < 0) {
+        OATPP_LOGE("session_journal", "Could not open session journal '%s': %s", this->path.c_str(), strerror(errno));
+        return;
+    }
+
+    OATPP_LOGI("session_journal", "Using session journal '%s' with %d torrents (%s)", this->path.c_str(), int(entries.size()),
+                humanize_bytes(size).c_str());
+}
+
+session_journal::~session_journal() {
+    flush();
+
+    if (fd >= 0)
+        ::close(fd);
+}
+
+void session_journal::load() {
+    int rfd = ::open(path.c_str(), O_RDONLY | journal_open_flags);
+    if (rfd < 0)
+        return;
+
+    // Whole journal is read sequentially at once, records are decoded from memory.
+    struct stat st {};
+    std::vector<char> buffer;
+    if (fstat(rfd, &st) == 0 && st.st_size > 0) {
+        buffer.resize(std::size_t(st.st_size));
+        std::size_t done = 0;
+        while (done < buffer.size()) {
+            auto n = ::read(rfd, buffer.data() + done, buffer.size() - done);
+            if (n <= 0)
+                break;
+            done += std::size_t(n);
+        }
+        buffer.resize(done);
+    }
+    ::close(rfd);
+
+    std::size_t offset = 0;
+    while (offset + journal_header_size <= buffer.size()) {
+        const char *header = buffer.data() + offset;
+
+        std::uint32_t magic, type, length, crc;
+        std::int64_t time;
+        std::memcpy(&magic, header, 4);
+        std::memcpy(&type, header + 4, 4);
+        std::string hash(header + 8, journal_hash_size);
+        std::memcpy(&time, header + 8 + journal_hash_size, 8);
+        std::memcpy(&length, header + 16 + journal_hash_size, 4);
+        std::memcpy(&crc, header + 20 + journal_hash_size, 4);
+
+        if (magic != journal_magic || offset + journal_header_size + length > buffer.size())
+            break;
+
+        const char *data = header + journal_header_size;
+        if (checksum(header, data, length) != crc)
+            break;
+
+        auto &entry = entries[hash];
+        if (type == record_torrent) {
+            entry.torrent = std::make_shared<const std::vector<char>>(data, data + length);
+            entry.added = time;
+        } else if (type == record_resume) {
+            entry.resume = std::make_shared<const std::vector<char>>(data, data + length);
+        } else {
+            entries.erase(hash);
+        }
+
+        offset += journal_header_size + length;
+    }
+
+    // Records after the first broken one come from an interrupted write.
+    if (offset < buffer.size()) {
+        OATPP_LOGE("session_journal::load", "Dropping %d bytes of broken records at the end of '%s'",
+                   int(buffer.size() - offset), path.c_str());
+        boost::system::error_code ec;
+        boost::filesystem::resize_file(path, offset, ec);
+        if (ec)
+            OATPP_LOGE("session_journal::load", "Could not truncate '%s': %s", path.c_str(), ec.message().c_str());
+    }
+
+    size = std::int64_t(offset);
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.torrent == nullptr) {
+            it = entries.erase(it);
+            continue;
+        }
+
+        live_size += entry_size(it->second);
+        ++it;
+    }
+}
+
+void session_journal::append(std::vector<char> &buffer, int type, const std::string &hash, std::int64_t time,
+                             const char *data, std::size_t length) const {
+    char header[journal_header_size] = {};
+    std::uint32_t magic = journal_magic;
+    std::uint32_t t = std::uint32_t(type);
+    std::uint32_t l = std::uint32_t(length);
+
+    std::memcpy(header, &magic, 4);
+    std::memcpy(header + 4, &t, 4);
+    std::memcpy(header + 8, hash.data(), std::min(hash.size(), journal_hash_size));
+    std::memcpy(header + 8 + journal_hash_size, &time, 8);
+    std::memcpy(header + 16 + journal_hash_size, &l, 4);
+
+    std::uint32_t crc = checksum(header, data, length);
+    std::memcpy(header + 20 + journal_hash_size, &crc, 4);
+
+    buffer.insert(buffer.end(), header, header + journal_header_size);
+    buffer.insert(buffer.end(), data, data + length);
+}
+
+std::int64_t session_journal::entry_size(const journal_entry &entry) const {
+    std::int64_t result = 0;
+    if (entry.torrent != nullptr)
+        result += std::int64_t(journal_header_size + entry.torrent->size());
+    if (entry.resume != nullptr)
+        result += std::int64_t(journal_header_size + entry.resume->size());
+
+    return result;
+}
+
+bool session_journal::is_open() const { return fd >= 0; }
+
+bool session_journal::is_empty() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return entries.empty();
+}
+
+std::map<std::string, journal_entry> session_journal::get_entries() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return entries;
+}
+
+bool session_journal::has_torrent(const std::string &hash) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return entries.find(hash) != entries.end();
+}
+
+bool session_journal::get_resume(const std::string &hash, std::vector<char> &data) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = entries.find(hash);
+    if (it == entries.end() || it->second.resume == nullptr)
+        return false;
+
+    data = *it->second.resume;
+    return true;
+}
+
+void session_journal::put_torrent(const std::string &hash, const std::vector<char> &data, std::int64_t added) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto &entry = entries[hash];
+    live_size -= entry_size(entry);
+    entry.torrent = std::make_shared<const std::vector<char>>(data);
+    entry.added = added;
+    live_size += entry_size(entry);
+
+    append(pending, record_torrent, hash, added, data.data(), data.size());
+}
+
+void session_journal::put_resume(const std::string &hash, const std::vector<char> &data) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // Resume data without metadata could not be loaded on startup.
+    auto it = entries.find(hash);
+    if (it == entries.end())
+        return;
+
+    live_size -= entry_size(it->second);
+    it->second.resume = std::make_shared<const std::vector<char>>(data);
+    live_size += entry_size(it->second);
+
+    append(pending, record_resume, hash, 0, data.data(), data.size());
+}
+
+void session_journal::remove(const std::string &hash) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto it = entries.find(hash);
+    if (it == entries.end())
+        return;
+
+    live_size -= entry_size(it->second);
+    entries.erase(it);
+
+    append(pending, record_remove, hash, 0, nullptr, 0);
+}
+
+void session_journal::flush() {
+    // Only one flush writes at a time, records are still added while it waits for the disk.
+    std::lock_guard<std::mutex> flush_guard(m_flushMutex);
+
+    std::vector<char> buffer;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (fd < 0 || pending.empty())
+            return;
+
+        buffer.swap(pending);
+    }
+
+    if (!write_all(fd, buffer.data(), buffer.size()) || sync_file(fd) != 0) {
+        OATPP_LOGE("session_journal::flush", "Could not write to '%s': %s", path.c_str(), strerror(errno));
+
+        // Torn bytes are cut off, otherwise load() would stop at them and drop every later record.
+        if (truncate_file(fd, size) != 0)
+            OATPP_LOGE("session_journal::flush", "Could not truncate '%s': %s", path.c_str(), strerror(errno));
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        buffer.insert(buffer.end(), pending.begin(), pending.end());
+        pending.swap(buffer);
+        return;
+    }
+
+    bool is_compact;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        size += std::int64_t(buffer.size());
+        is_compact = size > live_size * 2 + 1024 * 1024;
+    }
+
+    if (is_compact)
+        compact();
+}
+
+void session_journal::compact() {
+    // Records added after this snapshot stay pending and are appended to the new file.
+    std::vector<char> buffer;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (const auto &e : entries) {
+            append(buffer, record_torrent, e.first, e.second.added, e.second.torrent->data(), e.second.torrent->size());
+            if (e.second.resume != nullptr)
+                append(buffer, record_resume, e.first, 0, e.second.resume->data(), e.second.resume->size());
+        }
+    }
+
+    // Journal is replaced atomically, so a crash leaves either the old or the new one.
+    auto tmp_path = path + ".tmp";
+    int tfd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | journal_open_flags, 0644);
+    bool is_written = tfd >= 0 && write_all(tfd, buffer.data(), buffer.size()) && sync_file(tfd) == 0;
+    if (!is_written)
+        OATPP_LOGE("session_journal::compact", "Could not compact '%s': %s", path.c_str(), strerror(errno));
+    if (tfd >= 0)
+        ::close(tfd);
+    if (!is_written) {
+        ::unlink(tmp_path.c_str());
+        return;
+    }
+
+    // Open file cannot be replaced on Windows, so journal is closed first and reopened in any case.
+    //  Boost rename replaces existing file on Windows as well, unlike std::rename.
+    ::close(fd);
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        OATPP_LOGE("session_journal::compact", "Could not replace '%s': %s", path.c_str(), ec.message().c_str());
+        ::unlink(tmp_path.c_str());
+    }
+    int nfd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | journal_open_flags, 0644);
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    fd = nfd;
+    if (ec)
+        return;
+
+    OATPP_LOGI("session_journal::compact", "Compacted session journal from %s to %s", humanize_bytes(size).c_str(),
+               humanize_bytes(std::int64_t(buffer.size())).c_str());
+    size = std::int64_t(buffer.size());
+}
+
+} // namespace lh
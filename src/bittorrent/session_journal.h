@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lh {
+
+struct journal_entry {
+  public:
+    std::shared_ptr<const std::vector<char>> torrent;
+    std::shared_ptr<const std::vector<char>> resume;
+    std::int64_t added = 0;
+};
+
+// Append-only file with metadata and resume data of all saved torrents.
+//  Each record has a checksum, so a torn write at the end is dropped on startup.
+//  Writes are collected and appended with flush() from the resume writer thread,
+//  file is rewritten when superseded records take more space than live ones.
+struct session_journal {
+  private:
+    std::mutex m_mutex;
+    std::mutex m_flushMutex;
+
+    std::string path;
+    int fd;
+    std::int64_t size;
+    std::int64_t live_size;
+
+    std::map<std::string, journal_entry> entries;
+    std::vector<char> pending;
+
+    void load();
+    void compact();
+    void append(std::vector<char> &buffer, int type, const std::string &hash, std::int64_t time, const char *data,
+                std::size_t length) const;
+    std::int64_t entry_size(const journal_entry &entry) const;
+
+  public:
+    explicit session_journal(std::string path);
+    ~session_journal();
+
+    session_journal(const session_journal &) = delete;
+    session_journal &operator=(const session_journal &) = delete;
+
+    bool is_open() const;
+
+    bool is_empty();
+
+    std::map<std::string, journal_entry> get_entries();
+
+    bool has_torrent(const std::string &hash);
+
+    bool get_resume(const std::string &hash, std::vector<char> &data);
+
+    void put_torrent(const std::string &hash, const std::vector<char> &data, std::int64_t added);
+
+    void put_resume(const std::string &hash, const std::vector<char> &data);
+
+    void remove(const std::string &hash);
+
+    void flush();
+};
+
+} // namespace lh
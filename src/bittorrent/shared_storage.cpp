@@ -0,0 +1,42 @@
+#include "shared_storage.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <app/application.h>
+
+namespace lh {
+
+shared_storage::shared_storage(lt::storage_params const &params, std::int64_t size) : ring_storage(params, size) {
+    path = "memfd:lt2http";
+}
+
+int shared_storage::open_ring() {
+#if defined(MFD_ALLOW_SEALING)
+    int shared_fd = memfd_create("lt2http", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (shared_fd < 0)
+        return shared_fd;
+
+    // Clients map the whole arena, so it is sealed against shrinking under their mappings.
+    if (fcntl(shared_fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL) != 0) {
+        OATPP_LOGE("shared_storage::open_ring", "Could not seal memfd: %s", strerror(errno));
+    }
+
+    return shared_fd;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+int shared_storage::get_shared_fd() const { return fd; }
+
+lt::storage_interface *shared_storage_constructor(lt::storage_params const &params, lt::file_pool & /*unused*/) {
+    return new shared_storage(params, lh::memory_size);
+}
+
+} // namespace lh
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+#include <libtorrent/storage.hpp>
+#include <libtorrent/storage_defs.hpp>
+
+#include <bittorrent/ring_storage.h>
+
+namespace lh {
+
+// Memory storage, which keeps slots in a sealed memfd, so local clients can map
+//  it and read pieces without copying them through HTTP.
+struct shared_storage : ring_storage {
+  protected:
+    int open_ring() override;
+
+  public:
+    shared_storage(lt::storage_params const &params, std::int64_t size);
+
+    int get_shared_fd() const override;
+};
+
+lt::storage_interface *shared_storage_constructor(lt::storage_params const &params, lt::file_pool &);
+
+} // namespace lh
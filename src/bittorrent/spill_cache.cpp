@@ -0,0 +1,126 @@
+#include "spill_cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <oatpp/core/base/Environment.hpp>
+
+#include <utils/numbers.h>
+#include <utils/system.h>
+
+namespace lh {
+
+spill_cache::spill_cache(std::string path, int piece_count, std::int64_t piece_length, std::int64_t size)
+    : path(std::move(path)), fd(-1), slot_length(piece_length), bytes_saved(0) {
+    slot_count = piece_length > 0 ? int(size / piece_length) : 0;
+    if (slot_count > piece_count)
+        slot_count = piece_count;
+    if (slot_count <= 0)
+        return;
+
+    fd = ::open(this->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0600);
+    if (fd < 0) {
+        OATPP_LOGE("spill_cache", "Could not open spill file '%s': %s", this->path.c_str(), strerror(errno));
+        return;
+    }
+
+    slot_pieces.assign(slot_count, -1);
+    piece_slots.assign(piece_count, -1);
+    slot_accessed.assign(slot_count, std::chrono::system_clock::now());
+
+    OATPP_LOGI("spill_cache", "Using spill file '%s' with %d slots (%s)", this->path.c_str(), slot_count,
+                humanize_bytes(slot_count * slot_length).c_str());
+}
+
+spill_cache::~spill_cache() {
+    if (fd < 0)
+        return;
+
+    ::close(fd);
+    ::unlink(path.c_str());
+}
+
+bool spill_cache::is_open() const { return fd >= 0; }
+
+bool spill_cache::has(int pi) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return fd >= 0 && pi >= 0 && pi < int(piece_slots.size()) && piece_slots[pi] != -1;
+}
+
+bool spill_cache::store(int pi, const char *data, int length, int &evicted) {
+    evicted = -1;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (fd < 0 || pi < 0 || pi >= int(piece_slots.size()) || length > slot_length)
+        return false;
+
+    // Verified piece content does not change, so it is enough to refresh it.
+    if (piece_slots[pi] != -1) {
+        slot_accessed[piece_slots[pi]] = std::chrono::system_clock::now();
+        return true;
+    }
+
+    int si = -1;
+    for (int i = 0; i < slot_count; i++) {
+        if (slot_pieces[i] == -1) {
+            si = i;
+            break;
+        }
+        if (si == -1 || slot_accessed[i] < slot_accessed[si])
+            si = i;
+    }
+
+    // Evicted piece is reported even when the write fails, since its slot may be partially overwritten.
+    if (slot_pieces[si] != -1) {
+        evicted = slot_pieces[si];
+        piece_slots[evicted] = -1;
+        slot_pieces[si] = -1;
+    }
+
+    if (write_at(fd, data, std::size_t(length), si * slot_length) != length) {
+        OATPP_LOGE("spill_cache::store", "Could not write piece %d: %s", pi, strerror(errno));
+        return false;
+    }
+
+    slot_pieces[si] = pi;
+    piece_slots[pi] = si;
+    slot_accessed[si] = std::chrono::system_clock::now();
+    return true;
+}
+
+bool spill_cache::load(int pi, char *data, int length) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (fd < 0 || pi < 0 || pi >= int(piece_slots.size()) || piece_slots[pi] == -1)
+        return false;
+
+    int si = piece_slots[pi];
+    if (read_at(fd, data, std::size_t(length), si * slot_length) != length) {
+        OATPP_LOGE("spill_cache::load", "Could not read piece %d: %s", pi, strerror(errno));
+        piece_slots[pi] = -1;
+        slot_pieces[si] = -1;
+        return false;
+    }
+
+    slot_accessed[si] = std::chrono::system_clock::now();
+    bytes_saved += length;
+    return true;
+}
+
+int spill_cache::get_slot_count() const { return slot_count; }
+
+int spill_cache::get_used_count() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return int(std::count_if(slot_pieces.begin(), slot_pieces.end(), [](int pi) { return pi != -1; }));
+}
+
+std::int64_t spill_cache::get_bytes_saved() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return bytes_saved;
+}
+
+} // namespace lh
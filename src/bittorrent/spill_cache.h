@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lh {
+
+// File-backed second tier for pieces, evicted from memory storage.
+//  Each slot holds one piece, slots are reused in LRU order.
+struct spill_cache {
+  private:
+    std::mutex m_mutex;
+
+    std::string path;
+    int fd;
+
+    std::int64_t slot_length;
+    int slot_count;
+    std::vector<int> slot_pieces;
+    std::vector<int> piece_slots;
+    std::vector<std::chrono::time_point<std::chrono::system_clock>> slot_accessed;
+
+    std::int64_t bytes_saved;
+
+  public:
+    spill_cache(std::string path, int piece_count, std::int64_t piece_length, std::int64_t size);
+    ~spill_cache();
+
+    spill_cache(const spill_cache &) = delete;
+    spill_cache &operator=(const spill_cache &) = delete;
+
+    bool is_open() const;
+
+    bool has(int pi);
+
+    bool store(int pi, const char *data, int length, int &evicted);
+
+    bool load(int pi, char *data, int length);
+
+    int get_slot_count() const;
+
+    int get_used_count();
+
+    std::int64_t get_bytes_saved();
+};
+
+} // namespace lh
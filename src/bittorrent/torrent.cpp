@@ -2,8 +2,10 @@
 #include "utils/exceptions.h"
 
 #include <algorithm>
+#include <boost/algorithm/string.hpp>
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/download_priority.hpp>
+#include <libtorrent/hasher.hpp>
 #include <libtorrent/storage.hpp>
 #include <libtorrent/torrent_flags.hpp>
 #include <libtorrent/write_resume_data.hpp>
@@ -15,6 +17,7 @@
 #include <app/application.h>
 
 #include <bittorrent/file.h>
+#include <bittorrent/read_ahead.h>
 #include <bittorrent/reader.h>
 #include <bittorrent/session.h>
 
@@ -59,6 +62,110 @@ std::shared_ptr<File> Torrent::get_file(int index) {
     return *match;
 };
 
+std::shared_ptr<File> Torrent::next_file(const std::shared_ptr<File> &file) const {
+    int index = int(file->index());
+    if (index < 0 || index >= int(m_next_files.size()) || m_next_files[index] < 0)
+        return nullptr;
+
+    return m_files[m_next_files[index]];
+}
+
+void Torrent::update_next_files() {
+    // Next file is the one following in natural order among files of the same type,
+    // which matches episode order for usual season packs. Order is fixed once metadata is known.
+    std::vector<std::shared_ptr<File>> sorted = m_files;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const std::shared_ptr<File> &a, const std::shared_ptr<File> &b) {
+        auto ea = get_file_ext(a->path());
+        auto eb = get_file_ext(b->path());
+        if (!boost::iequals(ea, eb))
+            return boost::ilexicographical_compare(ea, eb);
+
+        return natural_less(a->path(), b->path());
+    });
+
+    m_next_files.assign(m_files.size(), -1);
+    for (std::size_t i = 0; i + 1 < sorted.size(); i++) {
+        if (boost::iequals(get_file_ext(sorted[i]->path()), get_file_ext(sorted[i + 1]->path())))
+            m_next_files[int(sorted[i]->index())] = int(sorted[i + 1]->index());
+    }
+}
+
+// Plain prefix match would take "Movie 2" as a subfolder of "Movie".
+static bool is_same_or_subdirectory(const std::string &path, const std::string &directory) {
+    if (directory.empty() || path == directory)
+        return true;
+
+    return path.size() > directory.size() && path.compare(0, directory.size(), directory) == 0 &&
+           (path[directory.size()] == '/' || path[directory.size()] == '\\');
+}
+
+std::vector<std::shared_ptr<File>> Torrent::sidecar_files(const std::shared_ptr<File> &file) const {
+    std::vector<std::shared_ptr<File>> result;
+
+    std::int64_t max_size = std::int64_t(lh::config().sidecar_max_size) * 1024 * 1024;
+    if (max_size <= 0 || !file->is_video())
+        return result;
+
+    int videos = int(std::count_if(m_files.begin(), m_files.end(), [](const std::shared_ptr<File> &f) { return f->is_video(); }));
+
+    // Sidecars are small subtitle files next to the video (or in its subfolders).
+    // With many videos in a torrent only files named after the video are taken.
+    auto directory = file->directory();
+    auto stem = boost::to_lower_copy(file->stem());
+    for (const auto &f : m_files) {
+        if (!f->is_sidecar() || f->size() > max_size || !is_same_or_subdirectory(f->directory(), directory))
+            continue;
+        if (videos > 1 && boost::to_lower_copy(f->name()).rfind(stem, 0) != 0)
+            continue;
+
+        result.push_back(f);
+    }
+
+    return result;
+}
+
+static std::string sidecar_owner(const std::shared_ptr<File> &file) { return "sidecar:" + std::to_string(file->index()); }
+
+void Torrent::prefetch_sidecars(const std::shared_ptr<File> &file) {
+    // Readers of the same video are registered from concurrent HTTP threads.
+    std::lock_guard<std::mutex> guard(m_sidecarsMutex);
+    if (!m_prefetched_sidecars.insert(file->index()).second)
+        return;
+
+    for (const auto &sidecar : sidecar_files(file)) {
+        OATPP_LOGI("Torrent::prefetch_sidecars", "Prefetching sidecar file '%s' for '%s'", sidecar->path().c_str(),
+                   file->path().c_str());
+
+        if (!is_memory_storage()) {
+            if (sidecar->priority() < lt::low_priority)
+                sidecar->set_priority(lt::low_priority);
+            continue;
+        }
+
+        // Pins are owned per video and expire, so sidecars do not hold the shared pinned budget forever.
+        try {
+            sidecar->pin(sidecar_owner(file), 0, sidecar->size(), std::chrono::seconds(lh::sidecar_pin_ttl), lt::low_priority);
+        } catch (std::exception &e) {
+            OATPP_LOGI("Torrent::prefetch_sidecars", "Could not keep sidecar file '%s' in memory: %s", sidecar->path().c_str(),
+                       e.what());
+        }
+    }
+}
+
+void Torrent::release_sidecars(const std::shared_ptr<File> &file) {
+    // New reader registers on the file before prefetching, so it is seen here and keeps the sidecars.
+    std::lock_guard<std::mutex> guard(m_sidecarsMutex);
+    if (file->has_readers() || !m_prefetched_sidecars.erase(file->index()))
+        return;
+
+    if (!is_memory_storage())
+        return;
+
+    for (const auto &sidecar : sidecar_files(file)) {
+        sidecar->unpin(sidecar_owner(file));
+    }
+}
+
 lt::storage_interface* Torrent::storage() {
     if (is_memory_storage())
         return m_memory_storage;
@@ -85,6 +192,8 @@ std::string Torrent::name() const {
 
 std::string Torrent::hash() const { return m_hash; }
 
+std::string Torrent::save_path() const { return m_nativeHandle.status(lt::torrent_handle::query_save_path).save_path; }
+
 std::int64_t Torrent::size() const {
     if (!is_valid())
         return -1;
@@ -117,6 +226,8 @@ int Torrent::pieces_count() const {
 
 bool Torrent::have_piece(lt::piece_index_t piece) const { return m_nativeHandle.have_piece(piece); };
 
+std::shared_ptr<const pieces_bitfield> Torrent::verified_pieces() const { return std::atomic_load(&m_pieces); }
+
 bool Torrent::has_metadata() const { return (m_nativeInfo && m_nativeInfo->is_valid() && (m_nativeInfo->num_files() > 0)); }
 
 void Torrent::update_metadata() {
@@ -147,6 +258,8 @@ void Torrent::on_metadata_received() {
                                                std::string(files.file_name(i)), files.file_size(i), files.file_offset(i),
                                                file_priority(i)));
     }
+
+    update_next_files();
 }
 
 void Torrent::remove(bool is_delete_files, bool is_delete_data) {
@@ -155,6 +268,10 @@ void Torrent::remove(bool is_delete_files, bool is_delete_data) {
     auto flags = is_delete_data && !is_memory_storage() ? lt::session::delete_files : lt::session::delete_partfile;
     m_nativeSession->remove_torrent(m_nativeHandle, flags);
 
+    auto journal = lh::session().journal();
+    if (journal != nullptr && (is_delete_files || is_memory_storage()))
+        journal->remove(m_hash);
+
     if (is_delete_files) {
         // Remove torrent file
         if (file_exists(m_torrentFile)) {
@@ -179,12 +296,17 @@ void Torrent::remove(bool is_delete_files, bool is_delete_data) {
     OATPP_LOGI("Torrent::remove", "Removed torrent with hash: %s", hash().c_str());
 }
 
-bool Torrent::is_memory_storage() const { return m_storageType == storage_type_t::memory; }
+// Ring storage is a memory storage, backed by a file, so it follows the same rules.
+bool Torrent::is_memory_storage() const { return m_storageType == storage_type_t::memory || m_storageType == storage_type_t::ring; }
+
+lh::storage_type_t Torrent::storage_type() const { return m_storageType; }
 
 void Torrent::update_status() { update_status(m_nativeHandle.status()); }
 
 void Torrent::update_status(const lt::torrent_status &nativeStatus) {
     m_nativeStatus = nativeStatus;
+    if (nativeStatus.pieces.size() > 0)
+        std::atomic_store(&m_pieces, std::make_shared<const pieces_bitfield>(nativeStatus.pieces));
     update_state();
 }
 
@@ -299,6 +421,8 @@ bool Torrent::is_buffering() const {
 
 bool Torrent::is_paused() const { return m_isStopped; }
 
+std::chrono::time_point<std::chrono::system_clock> Torrent::added_time() const { return m_addedTime; }
+
 bool Torrent::is_queued() const {
     // Torrent is Queued if it isn't in Paused state but paused internally
     return (!is_paused() && (m_nativeStatus.flags & lt::torrent_flags::auto_managed) &&
@@ -376,6 +500,17 @@ std::int64_t Torrent::total_download() const { return m_nativeStatus.all_time_do
 
 std::int64_t Torrent::total_upload() const { return m_nativeStatus.all_time_upload; }
 
+int Torrent::rewind_hits() const { return m_rewind_hits; }
+
+int Torrent::rewind_misses() const { return m_rewind_misses; }
+
+std::int64_t Torrent::redownload_saved() const {
+    if (!is_memory_storage() || m_memory_storage == nullptr)
+        return 0;
+
+    return m_memory_storage->get_spill_saved();
+}
+
 std::int64_t Torrent::active_time() const { return lt::total_seconds(m_nativeStatus.active_duration); }
 
 std::int64_t Torrent::finished_time() const { return lt::total_seconds(m_nativeStatus.finished_duration); }
@@ -553,16 +688,34 @@ void Torrent::dispatch_alert(const lt::alert *a) {
     case lt::tracker_error_alert::alert_type:
         handle_tracker_error_alert(static_cast<const lt::tracker_error_alert *>(a));
         break;
+    case lt::piece_finished_alert::alert_type:
+        handle_piece_finished_alert(static_cast<const lt::piece_finished_alert *>(a));
+        break;
     }
 }
 
 void Torrent::handle_save_resume_data_alert(const lt::save_resume_data_alert *p) {
-    OATPP_LOGI("Torrent::handle_save_resume_data_alert", "Saving resume data to: %s", m_resumeFile.c_str());
+    auto writer = lh::session().writer();
+    if (writer != nullptr)
+        writer->push(m_hash, resume_job{p->params, m_resumeFile, lh::session().journal()});
+};
 
-    std::ofstream of(m_resumeFile, std::ios_base::binary);
-    of.unsetf(std::ios_base::skipws);
-    auto const b = lt::write_resume_data_buf(p->params);
-    of.write(b.data(), b.size());
+void Torrent::handle_piece_finished_alert(const lt::piece_finished_alert *p) {
+    if (!is_memory_storage() || m_memory_storage == nullptr)
+        return;
+
+    auto cache = lh::session().cache();
+    if (cache == nullptr)
+        return;
+
+    std::vector<char> data;
+    int piece = static_cast<int>(p->piece_index);
+    if (!m_memory_storage->copy_piece(piece, data))
+        return;
+
+    // Piece is written by the read pool, so alert dispatch does not wait for disk.
+    auto hash = m_hash;
+    ReadPool::get().submit([cache, hash, piece, data = std::move(data)] { cache->store(hash, piece, data.data(), int(data.size())); });
 };
 
 void Torrent::handle_dht_reply_alert(const lt::dht_reply_alert *p) { 
@@ -725,9 +878,10 @@ void Torrent::dump(std::stringstream &ss) {
     ss << "    Pieces:\n";
     ss << "        ";
 
+    auto readers = live_readers();
     std::vector<int> reader_positions;
-    for (const auto& reader : m_readers) {
-        reader_positions.push_back(reader.second->piece_start());
+    for (const auto& reader : readers) {
+        reader_positions.push_back(reader->piece_start());
     }
 
     int total_prioritized = 0;
@@ -763,7 +917,15 @@ void Torrent::dump(std::stringstream &ss) {
         }
     }
     ss << Fmt("\n        Readers: <b>%d</b>, Stored: <b>%d</b>, Prioritized: <b>%d</b>",
-                m_readers.size(), total_have, total_prioritized);
+                readers.size(), total_have, total_prioritized);
+    if (is_memory_storage() && m_memory_storage != nullptr) {
+        ss << Fmt(", Pinned: <b>%d/%d</b>", m_memory_storage->get_pinned_count(), m_memory_storage->get_pinned_limit());
+    }
+    ss << Fmt(", Rewinds: <b>%d/%d</b>", rewind_hits(), rewind_misses());
+    if (is_memory_storage() && m_memory_storage != nullptr && m_memory_storage->get_spill_limit() > 0) {
+        ss << Fmt(", Spilled: <b>%d/%d</b>, Saved: <b>%s</b>", m_memory_storage->get_spill_count(),
+                  m_memory_storage->get_spill_limit(), humanize_bytes(m_memory_storage->get_spill_saved()).c_str());
+    }
     ss << "\n\n\n";
     ss << "    " << std::string(150, '*') << "\n";
     ss << "\n\n";
@@ -775,11 +937,17 @@ void Torrent::save_resume_data() const {
         m_nativeHandle.save_resume_data();
 }
 
+bool Torrent::need_save_resume() const {
+    return !is_memory_storage() && static_cast<bool>(m_nativeStatus.flags & lt::torrent_flags::need_save_resume);
+}
+
 void Torrent::save_torrent_file() const {
-    if (!has_metadata() || is_memory_storage() || file_exists(m_torrentFile))
+    if (!has_metadata() || is_memory_storage())
         return;
 
-    OATPP_LOGI("Torrent::save_torrent_file", "Saving torrent file to: %s", m_torrentFile.c_str());
+    auto journal = lh::session().journal();
+    if (journal != nullptr ? journal->has_torrent(m_hash) : file_exists(m_torrentFile))
+        return;
 
     const lt::create_torrent creator = lt::create_torrent(*m_nativeInfo);
     const lt::entry e = creator.generate();
@@ -787,11 +955,57 @@ void Torrent::save_torrent_file() const {
     std::vector<char> ret;
     lt::bencode(std::back_inserter(ret), e);
 
+    if (journal != nullptr) {
+        OATPP_LOGI("Torrent::save_torrent_file", "Saving torrent metadata to session journal: %s", m_hash.c_str());
+        journal->put_torrent(m_hash, ret, std::chrono::system_clock::to_time_t(m_addedTime));
+        return;
+    }
+
+    OATPP_LOGI("Torrent::save_torrent_file", "Saving torrent file to: %s", m_torrentFile.c_str());
+
     std::ofstream of(m_torrentFile, std::ios_base::binary);
     of.unsetf(std::ios_base::skipws);
     of.write(ret.data(), ret.size());
 };
 
+std::map<int, std::vector<char>> Torrent::export_pieces() const {
+    if (!is_memory_storage() || m_memory_storage == nullptr)
+        throw lh::TorrentException("Torrent is not using memory storage");
+
+    std::map<int, std::vector<char>> pieces;
+    for (int i = 0; i < m_nativeInfo->num_pieces(); i++) {
+        // Only verified pieces are exported, partial pieces are downloaded again.
+        std::vector<char> data;
+        if (have_piece(i) && m_memory_storage->copy_piece(i, data))
+            pieces[i] = std::move(data);
+    }
+
+    OATPP_LOGI("Torrent::export_pieces", "Exported %d pieces from memory for: %s", int(pieces.size()), hash().c_str());
+    return pieces;
+}
+
+void Torrent::import_pieces(const std::map<int, std::vector<char>> &pieces) {
+    for (const auto &p : pieces) {
+        m_nativeHandle.add_piece(lt::piece_index_t(p.first), p.second.data());
+    }
+
+    OATPP_LOGI("Torrent::import_pieces", "Imported %d pieces for: %s", int(pieces.size()), hash().c_str());
+}
+
+int Torrent::shared_memory_fd() const {
+    if (!is_memory_storage() || m_memory_storage == nullptr)
+        return -1;
+
+    return m_memory_storage->get_shared_fd();
+}
+
+std::vector<std::pair<int, int>> Torrent::shared_pieces() const {
+    if (shared_memory_fd() < 0)
+        return {};
+
+    return m_memory_storage->get_piece_slots();
+}
+
 std::vector<char> Torrent::generate() const {
     if (!has_metadata())
         throw lh::TorrentException("Torrent does not have metadata");
@@ -828,43 +1042,107 @@ int Torrent::readahead_pieces() const {
     return lh::file_readahead_pieces;
 };
 
-bool Torrent::has_readers() const { return !m_readers.empty(); };
+bool Torrent::has_readers() const { return !readers()->empty(); };
 
-void Torrent::register_reader(std::int64_t id, Reader* reader) { 
-    m_readers[id] = reader;
+void Torrent::register_reader(const std::shared_ptr<Reader> &reader) { 
+    {
+        std::lock_guard<std::mutex> guard(m_readersMutex);
+        auto readers = std::make_shared<reader_map>(*m_readers);
+        (*readers)[reader->id()] = reader;
+        std::atomic_store(&m_readers, std::shared_ptr<const reader_map>(std::move(readers)));
+    }
+
+    // Reader, starting behind the last read position of a file, is a rewind, when it replaces the reader,
+    //  which has made that read. Reader, which is still open, belongs to another client reading elsewhere.
+    //  It is a hit, when the piece is still available and does not need a re-download.
+    auto file = reader->file();
+    auto last = file->read_reader();
+    if (last != 0 && last != reader->id() && !file->has_reader(last) && file->read_position() > reader->position()) {
+        if (have_piece(reader->piece_start()))
+            m_rewind_hits++;
+        else
+            m_rewind_misses++;
+    }
+
+    prefetch_sidecars(reader->file());
 }
 
 void Torrent::unregister_reader(const std::int64_t &id) {
-    if (m_readers.find(id) != m_readers.end()) {
-        m_readers.erase(id);
+    std::lock_guard<std::mutex> guard(m_readersMutex);
+    if (m_readers->find(id) == m_readers->end())
+        return;
+
+    auto readers = std::make_shared<reader_map>(*m_readers);
+    readers->erase(id);
+    std::atomic_store(&m_readers, std::shared_ptr<const reader_map>(std::move(readers)));
+}
+
+std::shared_ptr<const reader_map> Torrent::readers() const {
+    return std::atomic_load(&m_readers);
+};
+
+std::vector<std::shared_ptr<Reader>> Torrent::live_readers() const {
+    std::vector<std::shared_ptr<Reader>> result;
+    for (const auto &p : *readers()) {
+        // Reader, which is being destroyed, can still be in the snapshot.
+        auto reader = p.second.lock();
+        if (reader != nullptr)
+            result.emplace_back(std::move(reader));
     }
+
+    return result;
 }
 
-std::map<std::int64_t, Reader*> Torrent::readers() const { return m_readers; };
+int Torrent::active_readers() const {
+    int result = 0;
+    for (const auto &p : *readers()) {
+        auto reader = p.second.lock();
+        if (reader != nullptr && !reader->is_closing())
+            result++;
+    }
+
+    return result;
+}
 
 void Torrent::prioritize() {
     int pieces_limit = readahead_pieces();
     int iter_count = -1;
     int readers_finished = 0;
     std::vector<int> reader_pieces;
+    std::map<std::int64_t, std::vector<int>> reader_windows;
+
+    // Part of readahead goes to the head of next file, when readers come close to the end,
+    //  so the switch to the next episode does not need buffering.
+    auto readers = live_readers();
+    std::vector<int> next_pieces = next_file_pieces(readers, pieces_limit);
+    pieces_limit -= int(next_pieces.size());
 
-    for (const auto &p : m_readers) {
-        p.second->set_iterated(false);
+    for (const auto &r : readers) {
+        r->set_iterated(false);
     }
 
-    while (readers_finished < m_readers.size() && pieces_limit > 0) {
+    while (readers_finished < readers.size() && pieces_limit > 0) {
         iter_count++;
-        for (const auto &p : m_readers) {
-            int index = p.second->piece_start() + iter_count;
-            if (p.second->is_iterated()) {
+        for (const auto &r : readers) {
+            int index = r->piece_start() + iter_count;
+            if (r->is_iterated()) {
                 continue;
             }
-            if (p.second->is_closing() || index > p.second->piece_end_limit()) {
-                p.second->set_iterated(true);
+            if (r->is_closing() || index > r->piece_end_limit()) {
+                r->set_iterated(true);
                 readers_finished++;
                 continue;
             }
             
+            // Windows of active readers are protected in memory storage up to their quota.
+            if (!r->is_idle()) {
+                if (iter_count == 0) {
+                    for (int piece = r->piece_retention_start(); piece < index; piece++)
+                        reader_windows[r->id()].push_back(piece);
+                }
+                reader_windows[r->id()].push_back(index);
+            }
+
             if (std::find(reader_pieces.begin(), reader_pieces.end(), index) != reader_pieces.end())
                 continue;
 
@@ -875,12 +1153,19 @@ void Torrent::prioritize() {
         }
     }
 
+    for (const auto &piece : next_pieces) {
+        if (std::find(reader_pieces.begin(), reader_pieces.end(), piece) == reader_pieces.end())
+            reader_pieces.push_back(piece);
+    }
+
     // Remove non-needed priorities to release place for new pieces
     std::vector<std::pair<lt::piece_index_t, lt::download_priority_t>> pieces_request;
     if (is_memory_storage()) {
+        m_memory_storage->expire_pins();
+
         auto priorities = m_nativeHandle.get_piece_priorities();
         for (std::size_t piece = 0; piece < priorities.size(); ++piece) {
-            if (priorities.at(piece) <= 0)
+            if (priorities.at(piece) <= 0 || m_memory_storage->is_pinned(int(piece)))
                 continue;
             if (std::find(reader_pieces.begin(), reader_pieces.end(), piece) == reader_pieces.end()) {
                 pieces_request.emplace_back(std::pair<lt::piece_index_t, lt::download_priority_t>{piece, 0});
@@ -914,11 +1199,47 @@ void Torrent::prioritize() {
         OATPP_LOGI("Torrent::prioritize", "Prioritizing %d pieces out of %d possible", pieces_request.size(), readahead_pieces())
         m_nativeHandle.prioritize_pieces(pieces_request);
     }
+    add_cached_pieces(reader_pieces);
     if (is_memory_storage()) {
-        m_memory_storage->update_reader_pieces(reader_pieces);
+        m_memory_storage->update_reader_pieces(reader_pieces, reader_windows);
     }
 };
 
+std::vector<int> Torrent::next_file_pieces(const std::vector<std::shared_ptr<Reader>> &readers, int readahead) const {
+    std::vector<int> result;
+
+    int share = readahead * lh::config().next_file_readahead_percents / 100;
+    if (share <= 0)
+        return result;
+
+    for (const auto &r : readers) {
+        // Reader is near the end, when its readahead window reaches the end of a file.
+        if (r->is_closing() || r->piece_end_limit() - r->piece_start() > readahead)
+            continue;
+
+        auto next = next_file(r->file());
+        if (next == nullptr)
+            continue;
+
+        // Take head of the next file and its last piece, where index is usually stored.
+        std::vector<int> candidates;
+        int head = std::max(1, share - 1);
+        for (int i = next->piece_start(); i <= next->piece_end() && int(candidates.size()) < head; i++) {
+            candidates.push_back(i);
+        }
+        candidates.push_back(next->piece_end());
+
+        for (const auto &piece : candidates) {
+            if (int(result.size()) >= share)
+                break;
+            if (std::find(result.begin(), result.end(), piece) == result.end())
+                result.push_back(piece);
+        }
+    }
+
+    return result;
+}
+
 void Torrent::update_buffer_progress() {
     if (!is_buffering())
         return;
@@ -934,6 +1255,8 @@ void Torrent::update_buffer_progress() {
         auto buffer_size = file->buffer_size();
         std::int64_t missing = 0;
 
+        add_cached_pieces(buffer_pieces);
+
         for (const auto& piece : buffer_pieces) {
             if (!have_piece(piece))
                 missing += piece_length_at(piece);
@@ -955,4 +1278,74 @@ void Torrent::update_buffer_progress() {
     }
 }
 
+void Torrent::add_cached_pieces(const std::vector<int> &pieces) {
+    if (!is_memory_storage() || m_nativeInfo == nullptr)
+        return;
+
+    auto cache = lh::session().cache();
+    if (cache == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_cacheMutex);
+
+    // Piece, that is verified by libtorrent, does not need to be tracked anymore.
+    auto verified = verified_pieces();
+    for (auto it = m_cache_added.begin(); it != m_cache_added.end();) {
+        if (it->first < verified->size() && verified->get_bit(lt::piece_index_t(it->first)))
+            it = m_cache_added.erase(it);
+        else
+            ++it;
+    }
+
+    auto now = std::chrono::system_clock::now();
+    std::vector<int> requested;
+    for (const auto &piece : pieces) {
+        if ((piece < verified->size() && verified->get_bit(lt::piece_index_t(piece))) || !cache->has(m_hash, piece))
+            continue;
+
+        // Piece, that was just requested, is still being loaded, written and checked.
+        auto added = m_cache_added.find(piece);
+        if (added != m_cache_added.end() && now - added->second < std::chrono::seconds(10))
+            continue;
+
+        m_cache_added[piece] = now;
+        requested.push_back(piece);
+    }
+
+    if (requested.empty())
+        return;
+
+    // Reading and hashing happen on the read pool, so prioritize() does no disk IO.
+    std::weak_ptr<Torrent> self = shared_from_this();
+    ReadPool::get().submit([self, cache, requested] {
+        auto torrent = self.lock();
+        if (torrent != nullptr)
+            torrent->load_cached_pieces(*cache, requested);
+    });
+}
+
+void Torrent::load_cached_pieces(piece_cache &cache, const std::vector<int> &pieces) {
+    for (const auto &piece : pieces) {
+        std::vector<char> data;
+        if (!cache.load(m_hash, piece, data))
+            continue;
+
+        auto index = lt::piece_index_t(piece);
+        if (int(data.size()) != m_nativeInfo->piece_size(index) ||
+            lt::hasher(data.data(), int(data.size())).final() != m_nativeInfo->hash_for_piece(index)) {
+            OATPP_LOGE("Torrent::load_cached_pieces", "Cached piece %d failed verification, removing", piece);
+            cache.remove(m_hash, piece);
+            continue;
+        }
+
+        // Torrent can be removed, while its pieces are loaded.
+        try {
+            m_nativeHandle.add_piece(index, data.data());
+        } catch (std::exception &e) {
+            OATPP_LOGE("Torrent::load_cached_pieces", "Could not add cached piece %d: %s", piece, e.what());
+            return;
+        }
+    }
+}
+
 } // namespace lh
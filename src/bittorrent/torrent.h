@@ -3,6 +3,8 @@
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include <mutex>
+#include <set>
 
 #include <boost/dynamic_bitset.hpp>
 
@@ -60,6 +62,10 @@ struct TrackerInfo {
 };
 
 class Session;
+struct piece_cache;
+
+typedef std::map<std::int64_t, std::weak_ptr<Reader>> reader_map;
+typedef lt::typed_bitfield<lt::piece_index_t> pieces_bitfield;
 
 class Torrent : public std::enable_shared_from_this<lh::Torrent> {
   private:
@@ -74,7 +80,14 @@ class Torrent : public std::enable_shared_from_this<lh::Torrent> {
     TorrentState m_state = TorrentState::Unknown;
 
     std::vector<std::shared_ptr<File>> m_files;
-    std::map<std::int64_t, Reader*> m_readers;
+    // Index of the next file in playback order for every file, or -1.
+    std::vector<int> m_next_files;
+    // Readers are published as an immutable snapshot, replaced under m_readersMutex,
+    //  so the prioritizer iterates them without locking HTTP threads.
+    std::shared_ptr<const reader_map> m_readers = std::make_shared<const reader_map>();
+    std::mutex m_readersMutex;
+    // Verified pieces of the last status update, published the same way for lookups without libtorrent calls.
+    std::shared_ptr<const pieces_bitfield> m_pieces = std::make_shared<const pieces_bitfield>();
     std::map<std::string, TrackerInfo> m_trackerInfos;
 
     std::string m_name;
@@ -85,6 +98,14 @@ class Torrent : public std::enable_shared_from_this<lh::Torrent> {
     std::string m_partsFile;
 
     Bitset m_deadline_pieces;
+    // Pieces, recently added from the piece cache, prioritize() runs on the prioritizer and HTTP threads.
+    std::map<int, std::chrono::time_point<std::chrono::system_clock>> m_cache_added;
+    std::mutex m_cacheMutex;
+    std::set<int> m_prefetched_sidecars;
+    std::mutex m_sidecarsMutex;
+
+    std::atomic<int> m_rewind_hits{0};
+    std::atomic<int> m_rewind_misses{0};
 
     bool m_hasSeedStatus = false;
     bool m_isStopped = false;
@@ -103,24 +124,32 @@ class Torrent : public std::enable_shared_from_this<lh::Torrent> {
     lt::torrent_status &status();
     std::vector<std::shared_ptr<File>> files();
     std::shared_ptr<File> get_file(int index);
+    std::shared_ptr<File> next_file(const std::shared_ptr<File> &file) const;
+    void update_next_files();
+    std::vector<std::shared_ptr<File>> sidecar_files(const std::shared_ptr<File> &file) const;
+    void prefetch_sidecars(const std::shared_ptr<File> &file);
+    void release_sidecars(const std::shared_ptr<File> &file);
     lt::storage_interface* storage();
 
     bool is_closing() const;
     bool is_valid() const;
     std::string hash() const;
     std::string name() const;
+    std::string save_path() const;
     std::int64_t size() const;
     int files_count() const;
     int piece_length() const;
     int piece_length_at(int index) const;
     int pieces_count() const;
     bool have_piece(lt::piece_index_t piece) const;
+    std::shared_ptr<const pieces_bitfield> verified_pieces() const;
 
     bool has_metadata() const;
     void update_metadata();
     void on_metadata_received();
     void remove(bool is_delete_files, bool is_delete_data);
     bool is_memory_storage() const;
+    lh::storage_type_t storage_type() const;
 
     void update_status();
     void update_status(const lt::torrent_status &nativeStatus);
@@ -131,6 +160,7 @@ class Torrent : public std::enable_shared_from_this<lh::Torrent> {
 
     bool is_buffering() const;
     bool is_paused() const;
+    std::chrono::time_point<std::chrono::system_clock> added_time() const;
     bool is_queued() const;
     bool is_checking() const;
     bool is_downloading() const;
@@ -154,6 +184,10 @@ class Torrent : public std::enable_shared_from_this<lh::Torrent> {
     std::int64_t total_download() const;
     std::int64_t total_upload() const;
 
+    int rewind_hits() const;
+    int rewind_misses() const;
+    std::int64_t redownload_saved() const;
+
     std::int64_t active_time() const;
     std::int64_t finished_time() const;
     std::int64_t seeding_time() const;
@@ -190,6 +224,7 @@ class Torrent : public std::enable_shared_from_this<lh::Torrent> {
     void handle_tracker_reply_alert(const lt::tracker_reply_alert *p);
     void handle_tracker_warning_alert(const lt::tracker_warning_alert *p);
     void handle_tracker_error_alert(const lt::tracker_error_alert *p);
+    void handle_piece_finished_alert(const lt::piece_finished_alert *p);
     void update_tracker(const std::string &name, std::string message, int number);
     void set_auto_managed(bool enable);
     void pause();
@@ -198,8 +233,13 @@ class Torrent : public std::enable_shared_from_this<lh::Torrent> {
     void dump(std::stringstream &ss);
 
     void save_resume_data() const;
+    bool need_save_resume() const;
     void save_torrent_file() const;
     std::vector<char> generate() const;
+    std::map<int, std::vector<char>> export_pieces() const;
+    void import_pieces(const std::map<int, std::vector<char>> &pieces);
+    int shared_memory_fd() const;
+    std::vector<std::pair<int, int>> shared_pieces() const;
 
     std::int64_t memory_size() const;
     void memory_size(std::int64_t size);
@@ -207,12 +247,17 @@ class Torrent : public std::enable_shared_from_this<lh::Torrent> {
     int readahead_pieces() const;
 
     bool has_readers() const;
-    std::map<std::int64_t, Reader*> readers() const;
-    void register_reader(std::int64_t id, Reader* reader);
+    std::shared_ptr<const reader_map> readers() const;
+    std::vector<std::shared_ptr<Reader>> live_readers() const;
+    int active_readers() const;
+    void register_reader(const std::shared_ptr<Reader> &reader);
     void unregister_reader(const std::int64_t &id);
 
     void prioritize();
+    std::vector<int> next_file_pieces(const std::vector<std::shared_ptr<Reader>> &readers, int readahead) const;
     void update_buffer_progress();
+    void add_cached_pieces(const std::vector<int> &pieces);
+    void load_cached_pieces(piece_cache &cache, const std::vector<int> &pieces);
 };
 
 } // namespace lh
\ No newline at end of file
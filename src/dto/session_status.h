@@ -20,6 +20,21 @@ class SessionStatusDto : public oatpp::DTO {
         info->description = "Is a session paused (bool)";
     }
     DTO_FIELD(Boolean, is_paused);
+
+    DTO_FIELD_INFO(alerts_dropped) {
+        info->description = "Number of alert types dropped due to alert queue overflow";
+    }
+    DTO_FIELD(Int64, alerts_dropped);
+
+    DTO_FIELD_INFO(is_loading) {
+        info->description = "Are saved torrents still being loaded on startup (bool)";
+    }
+    DTO_FIELD(Boolean, is_loading);
+
+    DTO_FIELD_INFO(load_progress) {
+        info->description = "Progress of loading saved torrents on startup (in percents)";
+    }
+    DTO_FIELD(Float64, load_progress);
 };
 
 #include OATPP_CODEGEN_END(DTO)
@@ -27,8 +42,11 @@ class SessionStatusDto : public oatpp::DTO {
 inline oatpp::Object<SessionStatusDto> sessionStatusDtoFromSession(lh::Session& session) {
     auto dto = SessionStatusDto::createShared();
 
-    dto->torrents_count = session.torrents().size();
+    dto->torrents_count = session.torrents()->size();
     dto->is_paused = session.is_paused();
+    dto->alerts_dropped = session.alerts_dropped();
+    dto->is_loading = session.is_loading();
+    dto->load_progress = session.load_progress();
 
     return dto;
 }
\ No newline at end of file
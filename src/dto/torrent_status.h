@@ -100,6 +100,21 @@ class TorrentStatusDto : public oatpp::DTO {
         info->description = "Total uploaded (bytes)";
     }
     DTO_FIELD(Int64, total_upload);
+
+    DTO_FIELD_INFO(rewind_hits) {
+        info->description = "Rewinds, served from already available pieces";
+    }
+    DTO_FIELD(Int32, rewind_hits);
+
+    DTO_FIELD_INFO(rewind_misses) {
+        info->description = "Rewinds, that needed pieces to be downloaded again";
+    }
+    DTO_FIELD(Int32, rewind_misses);
+
+    DTO_FIELD_INFO(redownload_saved) {
+        info->description = "Bytes, served from spill file instead of downloading again (bytes)";
+    }
+    DTO_FIELD(Int64, redownload_saved);
 };
 
 #include OATPP_CODEGEN_END(DTO)
@@ -132,5 +147,9 @@ inline oatpp::Object<TorrentStatusDto> torrentStatusDtoFromTorrent(const std::sh
     dto->total_download = torrent->total_download();
     dto->total_upload = torrent->total_upload();
 
+    dto->rewind_hits = torrent->rewind_hits();
+    dto->rewind_misses = torrent->rewind_misses();
+    dto->redownload_saved = torrent->redownload_saved();
+
     return dto;
 }
\ No newline at end of file
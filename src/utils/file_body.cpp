@@ -0,0 +1,66 @@
+#include "file_body.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <oatpp/core/base/Environment.hpp>
+
+#include <utils/system.h>
+
+namespace oatpp { namespace web { namespace protocol { namespace http { namespace outgoing {
+
+FileBody::FileBody(const std::string& path, v_int64 start, v_int64 size)
+  : m_fd(::open(path.c_str(), O_RDONLY | O_BINARY)),
+    m_position(start),
+    m_end(start + size)
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+  if (m_fd >= 0)
+    posix_fadvise(m_fd, off_t(start), off_t(size), POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+FileBody::~FileBody() {
+  if (m_fd >= 0)
+    ::close(m_fd);
+}
+
+bool FileBody::isOpen() const {
+  return m_fd >= 0;
+}
+
+v_io_size FileBody::read(void *buffer, v_buff_size count, async::Action& action) {
+  (void) action;
+
+  if (m_position >= m_end)
+    return 0;
+  if (m_fd < 0)
+    return oatpp::IOError::BROKEN_PIPE;
+
+  // Content-Length is already sent, so a failed or short read must break the response, not end it.
+  auto n = read_at(m_fd, buffer, std::size_t(std::min(v_int64(count), m_end - m_position)), m_position);
+  if (n <= 0) {
+    OATPP_LOGE("FileBody::read", "Could not read file at %s", std::to_string(m_position).c_str());
+    return oatpp::IOError::BROKEN_PIPE;
+  }
+
+  m_position += n;
+  return n;
+}
+
+void FileBody::declareHeaders(Headers& headers) {
+  (void) headers;
+  // DO NOTHING
+}
+
+p_char8 FileBody::getKnownData() {
+  return nullptr;
+}
+
+v_int64 FileBody::getKnownSize() {
+  return m_end - m_position;
+}
+
+}}}}}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "oatpp/web/protocol/http/outgoing/Body.hpp"
+
+namespace oatpp { namespace web { namespace protocol { namespace http { namespace outgoing {
+
+class FileBody : public Body {
+private:
+  int m_fd;
+  v_int64 m_position;
+  v_int64 m_end;
+public:
+
+  FileBody(const std::string& path, v_int64 start, v_int64 size);
+  ~FileBody() override;
+
+  bool isOpen() const;
+
+  v_io_size read(void *buffer, v_buff_size count, async::Action& action) override;
+
+  void declareHeaders(Headers& headers) override;
+
+  p_char8 getKnownData() override;
+
+  v_int64 getKnownSize() override;
+
+};
+
+}}}}}
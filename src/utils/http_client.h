@@ -1,6 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #define CPPHTTPLIB_OPENSSL_SUPPORT
 #include "httplib.h"
@@ -8,15 +14,85 @@
 #include <utils/http_url.h>
 #include <utils/strings.h>
 
-inline httplib::Result do_request(const std::string &uri) {
-    HTTPURL u(uri);
-    std::string req_path = u.path + "?" + u.query;
+// Keeps idle clients per host, so repeated requests to the same host reuse the connection.
+//  Servers close idle keep-alive connections, so clients idle for long are dropped,
+//  and a failed request on a reused client is retried once with a new one.
+class HttpClient {
+  private:
+    const std::size_t maxIdle = 4;
+    const std::chrono::seconds idleTimeout{30};
 
-    httplib::Client cli(Fmt("%s://%s:%d", u.protocol.c_str(), u.domain.c_str(), u.port).c_str());
-    
-    cli.enable_server_certificate_verification(false);
-    cli.set_follow_location(true);
-    cli.set_compress(true);
+    struct idle_client {
+        std::unique_ptr<httplib::Client> client;
+        std::chrono::steady_clock::time_point released;
+    };
 
-    return cli.Get(req_path.c_str());
-}
\ No newline at end of file
+    std::mutex m_mutex;
+    std::map<std::string, std::vector<idle_client>> m_idle;
+
+    static std::unique_ptr<httplib::Client> create(const std::string &host) {
+        auto cli = std::unique_ptr<httplib::Client>(new httplib::Client(host.c_str()));
+        cli->enable_server_certificate_verification(false);
+        cli->set_follow_location(true);
+        cli->set_compress(true);
+        cli->set_keep_alive(true);
+        return cli;
+    }
+
+    std::unique_ptr<httplib::Client> acquire(const std::string &host) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto &idle = m_idle[host];
+        auto now = std::chrono::steady_clock::now();
+        idle.erase(std::remove_if(idle.begin(), idle.end(),
+                                  [&](const idle_client &c) { return now - c.released > idleTimeout; }),
+                   idle.end());
+        if (idle.empty())
+            return nullptr;
+
+        auto cli = std::move(idle.back().client);
+        idle.pop_back();
+        return cli;
+    }
+
+    void release(const std::string &host, std::unique_ptr<httplib::Client> cli) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto &idle = m_idle[host];
+        if (idle.size() < maxIdle)
+            idle.push_back(idle_client{std::move(cli), std::chrono::steady_clock::now()});
+    }
+
+  public:
+    static HttpClient &instance() {
+        static HttpClient client;
+        return client;
+    }
+
+    httplib::Result get(const std::string &uri) {
+        HTTPURL u(uri);
+        std::string req_path = u.path + "?" + u.query;
+        std::string host = Fmt("%s://%s:%d", u.protocol.c_str(), u.domain.c_str(), u.port);
+
+        auto cli = acquire(host);
+        bool is_reused = cli != nullptr;
+        if (!is_reused)
+            cli = create(host);
+
+        auto res = cli->Get(req_path.c_str());
+
+        // Reused connection could be closed by the server in between, so the request gets a fresh one.
+        if (!res && is_reused) {
+            cli = create(host);
+            auto retry = cli->Get(req_path.c_str());
+            if (retry)
+                release(host, std::move(cli));
+            return retry;
+        }
+
+        // Client with a failed request may hold a broken connection, so it is not reused.
+        if (res)
+            release(host, std::move(cli));
+        return res;
+    }
+};
+
+inline httplib::Result do_request(const std::string &uri) { return HttpClient::instance().get(uri); }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cctype>
 #include <memory>
 #include <random>
 #include <sstream>
@@ -44,6 +46,32 @@ inline std::string to_hex(lt::sha1_hash const &s) {
     return ret.str();
 }
 
+inline bool from_hex(const std::string &hex, lt::sha1_hash &out) {
+    auto nibble = [](char c) {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    };
+
+    if (hex.size() != lt::sha1_hash::size() * 2)
+        return false;
+
+    for (std::size_t i = 0; i < lt::sha1_hash::size(); i++) {
+        int hi = nibble(hex[i * 2]);
+        int lo = nibble(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+
+        out.data()[i] = char((hi << 4) | lo);
+    }
+
+    return true;
+}
+
 inline std::string get_random_numeric(int size) {
     std::string possible_characters = "0123456789";
     std::random_device rd;
@@ -71,4 +99,46 @@ inline std::string get_file_ext(const std::string &s) {
     }
 
     return ("");
-}
\ No newline at end of file
+}
+
+// Compares strings in natural order, so "Episode 2" goes before "Episode 10".
+inline bool natural_less(const std::string &a, const std::string &b) {
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+    while (i < a.size() && j < b.size()) {
+        if (std::isdigit((unsigned char) a[i]) && std::isdigit((unsigned char) b[j])) {
+            std::size_t ei = i;
+            std::size_t ej = j;
+            while (ei < a.size() && std::isdigit((unsigned char) a[ei]))
+                ei++;
+            while (ej < b.size() && std::isdigit((unsigned char) b[ej]))
+                ej++;
+
+            auto na = a.substr(i, ei - i);
+            auto nb = b.substr(j, ej - j);
+            na.erase(0, std::min(na.find_first_not_of('0'), na.size()));
+            nb.erase(0, std::min(nb.find_first_not_of('0'), nb.size()));
+
+            if (na.size() != nb.size())
+                return na.size() < nb.size();
+            if (na != nb)
+                return na < nb;
+
+            i = ei;
+            j = ej;
+            continue;
+        }
+
+        // UTF-8 bytes of non-latin names are negative as char, which is undefined for ctype functions.
+        auto ca = std::tolower((unsigned char) a[i]);
+        auto cb = std::tolower((unsigned char) b[j]);
+        if (ca != cb)
+            return ca < cb;
+
+        i++;
+        j++;
+    }
+
+    return a.size() - i < b.size() - j;
+}
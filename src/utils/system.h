@@ -1,7 +1,14 @@
 #pragma once
 
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <fcntl.h>
+
 #ifdef _WIN32
 
+#include <io.h>
 #include <windows.h>
 
 inline std::int64_t get_total_system_memory()
@@ -12,6 +19,37 @@ inline std::int64_t get_total_system_memory()
     return std::int64_t(status.ullTotalPhys);
 }
 
+// Positional reads and writes, mingw has no pread/pwrite.
+inline std::int64_t read_at(int fd, void *data, std::size_t size, std::int64_t offset)
+{
+    OVERLAPPED ov{};
+    ov.Offset = DWORD(offset & 0xffffffff);
+    ov.OffsetHigh = DWORD(offset >> 32);
+
+    DWORD n = 0;
+    if (!ReadFile(HANDLE(_get_osfhandle(fd)), data, DWORD(size), &n, &ov)) {
+        if (GetLastError() == ERROR_HANDLE_EOF)
+            return 0;
+        errno = EIO;
+        return -1;
+    }
+    return std::int64_t(n);
+}
+
+inline std::int64_t write_at(int fd, const void *data, std::size_t size, std::int64_t offset)
+{
+    OVERLAPPED ov{};
+    ov.Offset = DWORD(offset & 0xffffffff);
+    ov.OffsetHigh = DWORD(offset >> 32);
+
+    DWORD n = 0;
+    if (!WriteFile(HANDLE(_get_osfhandle(fd)), data, DWORD(size), &n, &ov)) {
+        errno = GetLastError() == ERROR_DISK_FULL ? ENOSPC : EIO;
+        return -1;
+    }
+    return std::int64_t(n);
+}
+
 #else
 
 #include <unistd.h>
@@ -24,4 +62,18 @@ inline std::int64_t get_total_system_memory()
     return std::int64_t(pages) * std::int64_t(page_size);
 }
 
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+inline std::int64_t read_at(int fd, void *data, std::size_t size, std::int64_t offset)
+{
+    return std::int64_t(pread(fd, data, size, off_t(offset)));
+}
+
+inline std::int64_t write_at(int fd, const void *data, std::size_t size, std::int64_t offset)
+{
+    return std::int64_t(pwrite(fd, data, size, off_t(offset)));
+}
+
 #endif
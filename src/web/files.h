@@ -143,6 +143,128 @@ class FilesController : public oatpp::web::server::api::ApiController {
         }
     }
 
+    ENDPOINT_INFO(pin) {
+        info->summary = "Pin byte range of a file from torrent, identified by InfoHash, to keep it in memory storage";
+
+        info->pathParams.add<String>("infoHash").description = "Torrent InfoHash";
+        info->pathParams.add<String>("index").description = "File index";
+
+        info->queryParams.add<String>("owner").description = "Owner of a pin, used to unpin it later. Default: default";
+        info->queryParams.add<String>("owner").required = false;
+
+        info->queryParams.add<String>("offset").description = "Offset of a range inside of a file (in bytes). Default: 0";
+        info->queryParams.add<String>("offset").required = false;
+
+        info->queryParams.add<String>("length").description = "Length of a range (in bytes)";
+        info->queryParams.add<String>("length").required = true;
+
+        info->queryParams.add<String>("ttl").description = "Seconds to keep a pin. Value 0 keeps it until unpinned. Default: 0";
+        info->queryParams.add<String>("ttl").required = false;
+
+        info->addResponse<Object<FileOperationDto>>(Status::CODE_200, "application/json");
+        info->addResponse<Object<FileOperationDto>>(Status::CODE_500, "application/json");
+    }
+    ENDPOINT("GET", "/torrents/{infoHash}/files/{index}/pin", pin, 
+            PATH(String, hash_param, "infoHash"),
+            PATH(String, index_param, "index"),
+            QUERY(String, owner_param, "owner", "default"),
+            QUERY(String, offset_param, "offset", "0"),
+            QUERY(String, length_param, "length", "0"),
+            QUERY(String, ttl_param, "ttl", "0")
+    ) {
+        auto hash = uri_unescape(hash_param->std_str());
+        auto index = -1;
+
+        try {
+            index = std::stoi(uri_unescape(index_param->std_str()));
+            auto owner = uri_unescape(owner_param->std_str());
+            auto offset = std::stoll(uri_unescape(offset_param->std_str()));
+            auto length = std::stoll(uri_unescape(length_param->std_str()));
+            auto ttl = std::stoi(uri_unescape(ttl_param->std_str()));
+
+            boost::trim(hash);
+            boost::to_lower(hash);
+
+            OATPP_LOGI("FilesController::pin", "Pinning range %s+%s of file index '%d' with torrent infohash: %s",
+                       std::to_string(offset).c_str(), std::to_string(length).c_str(), index, hash.c_str())
+
+            auto torrent = lh::session().get_torrent(hash);
+            auto file = torrent->get_file(index);
+            file->pin(owner, offset, length, std::chrono::seconds(ttl));
+
+            auto dto = FileOperationDto::createShared();
+            dto->success = true;
+            dto->hash = hash.c_str();
+            dto->id = index;
+            dto->path = file->path().c_str();
+
+            return createDtoResponse(Status::CODE_200, dto);
+        } catch (std::exception &e) {
+            OATPP_LOGE("FilesController::pin", "Error pinning file range: %s", e.what())
+
+            auto dto = FileOperationDto::createShared();
+            dto->hash = hash.c_str();
+            dto->id = index;
+            dto->success = false;
+            dto->error = e.what();
+
+            return createDtoResponse(Status::CODE_500, dto);
+        }
+    }
+
+    ENDPOINT_INFO(unpin) {
+        info->summary = "Remove pins of a file from torrent, identified by InfoHash";
+
+        info->pathParams.add<String>("infoHash").description = "Torrent InfoHash";
+        info->pathParams.add<String>("index").description = "File index";
+
+        info->queryParams.add<String>("owner").description = "Owner of pins to remove. Default: default";
+        info->queryParams.add<String>("owner").required = false;
+
+        info->addResponse<Object<FileOperationDto>>(Status::CODE_200, "application/json");
+        info->addResponse<Object<FileOperationDto>>(Status::CODE_500, "application/json");
+    }
+    ENDPOINT("GET", "/torrents/{infoHash}/files/{index}/unpin", unpin, 
+            PATH(String, hash_param, "infoHash"),
+            PATH(String, index_param, "index"),
+            QUERY(String, owner_param, "owner", "default")
+    ) {
+        auto hash = uri_unescape(hash_param->std_str());
+        auto index = -1;
+
+        try {
+            index = std::stoi(uri_unescape(index_param->std_str()));
+            auto owner = uri_unescape(owner_param->std_str());
+
+            boost::trim(hash);
+            boost::to_lower(hash);
+
+            OATPP_LOGI("FilesController::unpin", "Unpinning file index '%d' with torrent infohash: %s", index, hash.c_str())
+
+            auto torrent = lh::session().get_torrent(hash);
+            auto file = torrent->get_file(index);
+            file->unpin(owner);
+
+            auto dto = FileOperationDto::createShared();
+            dto->success = true;
+            dto->hash = hash.c_str();
+            dto->id = index;
+            dto->path = file->path().c_str();
+
+            return createDtoResponse(Status::CODE_200, dto);
+        } catch (std::exception &e) {
+            OATPP_LOGE("FilesController::unpin", "Error unpinning file: %s", e.what())
+
+            auto dto = FileOperationDto::createShared();
+            dto->hash = hash.c_str();
+            dto->id = index;
+            dto->success = false;
+            dto->error = e.what();
+
+            return createDtoResponse(Status::CODE_500, dto);
+        }
+    }
+
     ENDPOINT_INFO(info) {
         info->summary = "Get info for file from torrent, identified by InfoHash";
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <sstream>
+#include <vector>
 
 #include "oatpp/core/macro/codegen.hpp"
 #include "oatpp/parser/json/mapping/ObjectMapper.hpp"
@@ -54,7 +55,7 @@ class SessionController : public oatpp::web::server::api::ApiController {
             <<  "</head><body>";
 
         auto torrents = lh::session().torrents();
-        for (auto &torrent : torrents) {
+        for (auto &torrent : *torrents) {
             ss << "<pre>";
             torrent->dump(ss);
             ss << "</pre>";
@@ -146,7 +147,7 @@ class SessionController : public oatpp::web::server::api::ApiController {
         info->queryParams.add<String>("file").required = true;
 
         info->queryParams.add<String>("storage").description =
-            "Define which storage to use. Values: file/memory/automatic. Default: automatic (taken from confguration)";
+            "Define which storage to use. Values: file/memory/ring/automatic. Default: automatic (taken from confguration)";
         info->queryParams.add<String>("storage").required = false;
 
         info->addResponse<Object<TorrentAddDto>>(Status::CODE_200, "application/json");
@@ -165,13 +166,13 @@ class SessionController : public oatpp::web::server::api::ApiController {
             request->transferBody(&reader);
 
             auto file = multipart->getNamedPart("file");
-            std::string uri = path_append(lh::config().torrents_path, "tmp_" + get_random_numeric(10) + ".torrent");
+            if (file == nullptr || file->getInMemoryData() == nullptr)
+                throw lh::Exception("Missing file parameter");
 
-            OATPP_LOGI("SessionController::add_file", "Saving uploaded file to: %s", uri.c_str())
+            auto body = file->getInMemoryData();
+            std::vector<char> data(body->c_str(), body->c_str() + body->getSize());
 
-            save_file(uri, file->getInMemoryData()->c_str(), file->getInMemoryData()->getSize());
-
-            auto torrent = lh::session().add_torrent(uri, false, storage, true, std::chrono::system_clock::now());
+            auto torrent = lh::session().add_torrent(data, false, storage, true, std::chrono::system_clock::now());
 
             auto dto = TorrentAddDto::createShared();
             dto->success = true;
@@ -197,20 +198,28 @@ class SessionController : public oatpp::web::server::api::ApiController {
         info->queryParams.add<String>("uri").required = true;
 
         info->queryParams.add<String>("storage").description =
-            "Define which storage to use. Values: file/memory/automatic. Default: automatic (taken from confguration)";
+            "Define which storage to use. Values: file/memory/ring/automatic. Default: automatic (taken from confguration)";
         info->queryParams.add<String>("storage").required = false;
 
+        info->queryParams.add<String>("resolve").description =
+            "Wait for magnet metadata up to magnet_resolve_timeout before responding. Values: true/false. Default: false";
+        info->queryParams.add<String>("resolve").required = false;
+
         info->addResponse<Object<TorrentAddDto>>(Status::CODE_200, "application/json");
         info->addResponse<Object<TorrentAddDto>>(Status::CODE_500, "application/json");
     }
     ENDPOINT("GET", "/service/add/uri", add_uri, 
             QUERY(String, uri_param, "uri", ""),
-            QUERY(String, storage_param, "storage", "automatic")
+            QUERY(String, storage_param, "storage", "automatic"),
+            QUERY(String, resolve_param, "resolve", "false")
     ) {
         try {
             auto uri = uri_unescape(uri_param->std_str());
             auto storage = lh::from_string<lh::storage_type_t, lh::js_storage_type_t_string_struct>(storage_param->c_str());
 
+            auto is_resolve = uri_unescape(resolve_param->std_str()) == "true";
+
+            std::shared_ptr<lh::Torrent> torrent;
             if (uri.rfind("http", 0) == 0) {
                 OATPP_LOGI("SessionController::add_uri", "Downloading torrent file from: %s", uri.c_str());
 
@@ -220,14 +229,13 @@ class SessionController : public oatpp::web::server::api::ApiController {
                 if (res->status != 200)
                     throw lh::Exception(Fmt("Could not download file from url '%s'. Status: %d", uri.c_str(), res->status));
 
-                uri = path_append(lh::config().torrents_path, "tmp_" + get_random_numeric(10) + ".torrent");
-
-                OATPP_LOGI("SessionController::add_file", "Saving uploaded file to: %s", uri.c_str())
-
-                save_file(uri, res->body.c_str(), res->body.size());
+                std::vector<char> data(res->body.begin(), res->body.end());
+                torrent = lh::session().add_torrent(data, false, storage, true, std::chrono::system_clock::now());
+            } else {
+                torrent = lh::session().add_torrent(uri, false, storage, true, std::chrono::system_clock::now());
             }
-
-            auto torrent = lh::session().add_torrent(uri, false, storage, true, std::chrono::system_clock::now());
+            if (is_resolve)
+                lh::session().wait_for_metadata(torrent);
 
             auto dto = TorrentAddDto::createShared();
             dto->success = true;
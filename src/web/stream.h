@@ -23,6 +23,7 @@
 #include <dto/file_status.h>
 
 #include <utils/empty_body.h>
+#include <utils/file_body.h>
 #include <utils/stream_body.h>
 
 #include <utils/path.h>
@@ -40,9 +41,9 @@ class StreamController : public oatpp::web::server::api::ApiController {
         auto hash = uri_unescape(hash_param->std_str());
         auto index = -1;
 
-        OATPP_LOGD("FilesController::stream", "Request Header: Method = %s", request->getStartingLine().method.toString()->c_str())
+        OATPP_LOGD("StreamController::stream", "Request Header: Method = %s", request->getStartingLine().method.toString()->c_str())
         for (const auto &header : request->getHeaders().getAll()) {
-            OATPP_LOGD("FilesController::stream", "Request Header: %s = %s", header.first.std_str().c_str(),
+            OATPP_LOGD("StreamController::stream", "Request Header: %s = %s", header.first.std_str().c_str(),
                        header.second.std_str().c_str())
         }
 
@@ -67,21 +68,49 @@ class StreamController : public oatpp::web::server::api::ApiController {
             if (range.end == 0)
                 range.end = file->size() - 1;
 
-            OATPP_LOGD("FilesController::stream", "Range: start=%s, end=%s", std::to_string(range.start).c_str(),
+            OATPP_LOGD("StreamController::stream", "Range: start=%s, end=%s", std::to_string(range.start).c_str(),
                        std::to_string(range.end).c_str())
 
             std::int64_t contentLength = file->size() - range.start;
             std::shared_ptr<OutgoingResponse> response = nullptr;
+            std::shared_ptr<oatpp::web::protocol::http::outgoing::Body> body = nullptr;
+
+            bool is_head = request->getStartingLine().method.toString() == "HEAD";
+
+            // Completed file on file storage does not need prioritization and waiting for pieces,
+            //  so it is served straight from disk, without a reader.
+            if (!is_head && !torrent->is_memory_storage() && file->is_complete()) {
+                auto fileBody = std::make_shared<oatpp::web::protocol::http::outgoing::FileBody>(file->full_path(), range.start, contentLength);
+                if (fileBody->isOpen()) {
+                    OATPP_LOGI("StreamController::stream", "Serving completed file from disk: %s", file->path().c_str())
+                    body = fileBody;
+                }
+            }
+
+            // HEAD still opens a reader, so the player's probe starts prioritization early.
+            if (body == nullptr) {
+                // Stream limits keep readers from piling up and starving the active viewer.
+                auto reader = lh::session().open_stream(torrent, file, range);
+                if (reader == nullptr && !is_head) {
+                    auto dto = FileOperationDto::createShared();
+                    dto->hash = hash.c_str();
+                    dto->id = index;
+                    dto->success = false;
+                    dto->error = "Too many active streams";
+
+                    auto busy = createDtoResponse(Status::CODE_503, dto);
+                    busy->putHeader("Retry-After", std::to_string(std::max(1, lh::config().stream_queue_timeout)).c_str());
+                    return busy;
+                }
+
+                if (reader != nullptr)
+                    body = std::make_shared<oatpp::web::protocol::http::outgoing::StreamBody>(reader, contentLength);
+            }
 
-            auto reader = std::make_shared<lh::Reader>(torrent, file, range);
-            file->register_reader(reader->id(), reader.get());
-            torrent->register_reader(reader->id(), reader.get());
-            
-            if (request->getStartingLine().method.toString() == "HEAD") {
-                auto body = std::make_shared<oatpp::web::protocol::http::outgoing::EmptyBody>(file->size());
+            if (is_head) {
+                body = std::make_shared<oatpp::web::protocol::http::outgoing::EmptyBody>(file->size());
                 response = OutgoingResponse::createShared(Status::CODE_200, body);
             } else {
-                auto body = std::make_shared<oatpp::web::protocol::http::outgoing::StreamBody>(reader, contentLength);
                 response = OutgoingResponse::createShared(Status::CODE_206, body);
 
                 oatpp::web::protocol::http::ContentRange contentRange(oatpp::web::protocol::http::ContentRange::UNIT_BYTES,
@@ -98,13 +127,13 @@ class StreamController : public oatpp::web::server::api::ApiController {
                 response->putHeader(Header::CONTENT_TYPE, mimeType.c_str());
 
             for (const auto &header : response->getHeaders().getAll()) {
-                OATPP_LOGD("FilesController::stream", "Response Header: %s = %s", header.first.std_str().c_str(),
+                OATPP_LOGD("StreamController::stream", "Response Header: %s = %s", header.first.std_str().c_str(),
                         header.second.std_str().c_str())
             }
 
             return response;
         } catch (std::exception &e) {
-            OATPP_LOGE("FilesController::stream", "Error getting stream from file: %s", e.what())
+            OATPP_LOGE("StreamController::stream", "Error getting stream from file: %s", e.what())
 
             auto dto = FileOperationDto::createShared();
             dto->hash = hash.c_str();
@@ -152,6 +181,7 @@ class StreamController : public oatpp::web::server::api::ApiController {
 
         info->addResponse<oatpp::swagger::Binary>(Status::CODE_206, "application/octet-stream");
         info->addResponse<Object<FileOperationDto>>(Status::CODE_500, "application/json");
+        info->addResponse<Object<FileOperationDto>>(Status::CODE_503, "application/json");
     }
     ENDPOINT("GET", "/torrents/{infoHash}/files/{index}/stream/{file_name}", stream, 
             PATH(String, hash_param, "infoHash"),
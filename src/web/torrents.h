@@ -53,7 +53,7 @@ class TorrentsController : public oatpp::web::server::api::ApiController {
             auto list = oatpp::List<oatpp::Object<TorrentInfoDto>>::createShared();
 
             auto torrents = lh::session().torrents();
-            for (auto &torrent : torrents) {
+            for (auto &torrent : *torrents) {
                 list->push_back(torrentInfoDtoFromTorrent(torrent, is_status));
             }
 
@@ -198,6 +198,44 @@ class TorrentsController : public oatpp::web::server::api::ApiController {
         }
     }
 
+    ENDPOINT_INFO(promote) {
+        info->summary = "Move memory storage torrent, identified by InfoHash, to file storage, keeping downloaded pieces";
+
+        info->pathParams.add<String>("infoHash").description = "Torrent InfoHash";
+
+        info->addResponse<Object<TorrentOperationDto>>(Status::CODE_200, "application/json");
+        info->addResponse<Object<TorrentOperationDto>>(Status::CODE_500, "application/json");
+    }
+    ENDPOINT("GET", "/torrents/{infoHash}/promote", promote, 
+        PATH(String, hash_param, "infoHash")
+    ) {
+        auto hash = uri_unescape(hash_param->std_str());
+
+        try {
+            boost::trim(hash);
+            boost::to_lower(hash);
+
+            OATPP_LOGI("TorrentsController::promote", "Promoting torrent with infohash: %s", hash.c_str())
+
+            lh::session().promote_torrent(hash);
+
+            auto dto = TorrentOperationDto::createShared();
+            dto->success = true;
+            dto->hash = hash.c_str();
+
+            return createDtoResponse(Status::CODE_200, dto);
+        } catch (std::exception &e) {
+            OATPP_LOGE("TorrentsController::promote", "Error promoting torrent: %s", e.what())
+
+            auto dto = TorrentOperationDto::createShared();
+            dto->hash = hash.c_str();
+            dto->success = false;
+            dto->error = e.what();
+
+            return createDtoResponse(Status::CODE_500, dto);
+        }
+    }
+
     ENDPOINT_INFO(info) {
         info->summary = "Get info for torrent, identified by InfoHash";
 
@@ -0,0 +1,94 @@
+#include "unix_connection_provider.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "oatpp/network/tcp/Connection.hpp"
+
+namespace lh {
+
+UnixConnectionProvider::UnixConnectionProvider(std::string path) : m_path(std::move(path)) {
+    setProperty(PROPERTY_HOST, m_path);
+    setProperty(PROPERTY_PORT, "0");
+
+    sockaddr_un addr{};
+    if (m_path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Unix socket path is too long: " + m_path);
+
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_fd < 0)
+        throw std::runtime_error(std::string("Could not create Unix socket: ") + strerror(errno));
+    ::fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // Stale socket of previous run would fail the bind.
+    ::unlink(m_path.c_str());
+
+    if (::bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || ::listen(m_fd, 64) != 0) {
+        auto error = std::string(strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        throw std::runtime_error("Could not listen on Unix socket " + m_path + ": " + error);
+    }
+
+    OATPP_LOGI("UnixConnectionProvider", "Listening for HTTP connections on %s", m_path.c_str());
+}
+
+UnixConnectionProvider::~UnixConnectionProvider() {
+    stop();
+
+    // Descriptor is closed only here, when no server loop can be polling it anymore.
+    int fd = m_fd.exchange(-1);
+    if (fd >= 0)
+        ::close(fd);
+}
+
+std::shared_ptr<oatpp::data::stream::IOStream> UnixConnectionProvider::get() {
+    // Wait with timeout, so server loop can check its stop condition.
+    while (!m_closed) {
+        pollfd pfd{m_fd, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 500);
+        if (ready <= 0)
+            continue;
+
+        int client = ::accept(m_fd, nullptr, nullptr);
+        if (client < 0)
+            return nullptr;
+        ::fcntl(client, F_SETFD, FD_CLOEXEC);
+
+        return std::make_shared<oatpp::network::tcp::Connection>(client);
+    }
+
+    return nullptr;
+}
+
+oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream> &>
+UnixConnectionProvider::getAsync() {
+    throw std::runtime_error("UnixConnectionProvider does not support async connections");
+}
+
+void UnixConnectionProvider::invalidate(const std::shared_ptr<oatpp::data::stream::IOStream> &connection) {
+    auto c = std::static_pointer_cast<oatpp::network::tcp::Connection>(connection);
+    ::shutdown(c->getHandle(), SHUT_RDWR);
+}
+
+void UnixConnectionProvider::stop() {
+    if (m_closed.exchange(true) || m_fd < 0)
+        return;
+
+    // Shutdown wakes a blocked accept, while the descriptor stays valid until destruction.
+    ::shutdown(m_fd, SHUT_RDWR);
+    ::unlink(m_path.c_str());
+}
+
+} // namespace lh
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "oatpp/network/ConnectionProvider.hpp"
+
+namespace lh {
+
+// Server connection provider, which accepts HTTP connections on a Unix domain socket.
+//  Accepted sockets are wrapped into the same stream type as TCP connections,
+//  so router, controllers and interceptors are shared with the TCP listener.
+class UnixConnectionProvider : public oatpp::network::ServerConnectionProvider {
+  private:
+    std::string m_path;
+    std::atomic<bool> m_closed{false};
+    std::atomic<int> m_fd{-1};
+
+  public:
+    explicit UnixConnectionProvider(std::string path);
+    ~UnixConnectionProvider() override;
+
+    static std::shared_ptr<UnixConnectionProvider> createShared(const std::string &path) {
+        return std::make_shared<UnixConnectionProvider>(path);
+    }
+
+    std::shared_ptr<oatpp::data::stream::IOStream> get() override;
+
+    oatpp::async::CoroutineStarterForResult<const std::shared_ptr<oatpp::data::stream::IOStream> &>
+    getAsync() override;
+
+    void invalidate(const std::shared_ptr<oatpp::data::stream::IOStream> &connection) override;
+
+    void stop() override;
+};
+
+} // namespace lh